@@ -0,0 +1,207 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   BatchEval.cpp                                                            */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Batched evaluation implementation: the scalar, SSE4.1 and AVX2           */
+/*   kernels and the choice between them                                      */
+/* ========================================================================== */
+
+#include "BatchEval.h"
+#include <stddef.h> // for offsetof
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define BATCH_EVAL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h> // for __cpuid and _xgetbv
+#define TARGET_SSE41
+#define TARGET_AVX2
+#else
+// the kernels are compiled for their instruction set whatever the flags of the build, they only run when the processor has it
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+/*
+ * The kernels evaluate one position per lane: the lanes hold the white, black and kings bitboards of
+ * different positions, and the stone values of one square are added to all of them in one step.
+ * The squares are walked from 31 down, the bitboards shifted left once per square so the top bit of
+ * every lane is the square's: the float blends pick the value of a lane by that bit alone,
+ * man or king first, then white or black, and an arithmetic shift of the stones masks out the empty lanes.
+ */
+struct S_SquareWeights /* stone values of every square, from stoneValue */
+{
+	int whiteMan[PLAYABLE_CELLS];
+	int whiteKing[PLAYABLE_CELLS];
+	int blackMan[PLAYABLE_CELLS];
+	int blackKing[PLAYABLE_CELLS];
+};
+
+/**
+ * Returns the stone values the kernels add, read once from the table of scorePosition.
+ */
+static const S_SquareWeights &squareWeights() {
+	static const S_SquareWeights weights = [] {
+		S_SquareWeights table;
+		for (int square = 0; square < PLAYABLE_CELLS; square++) {
+			table.whiteMan[square] = stoneValue(PLAYER, false, square);
+			table.whiteKing[square] = stoneValue(PLAYER, true, square);
+			table.blackMan[square] = stoneValue(COMPUTER, false, square);
+			table.blackKing[square] = stoneValue(COMPUTER, true, square);
+		}
+		return table;
+	}();
+	return weights;
+}
+
+/**
+ * Scores the positions one by one, the reference of the kernels.
+ */
+static void scoreScalar(const S_Position *positions, int count, int *scores) {
+	for (int i = 0; i < count; i++)
+		scores[i] = scorePosition(positions[i]);
+}
+
+#if defined(BATCH_EVAL_X86)
+/**
+ * Scores 4 positions per step with SSE4.1, the last count % 4 with scorePosition.
+ */
+TARGET_SSE41 static void scoreSse41(const S_Position *positions, int count, int *scores) {
+	const S_SquareWeights &weights = squareWeights();
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const S_Position *p = positions + i;
+		const __m128i white = _mm_setr_epi32((int)p[0].white, (int)p[1].white, (int)p[2].white, (int)p[3].white);
+		__m128i black = _mm_setr_epi32((int)p[0].black, (int)p[1].black, (int)p[2].black, (int)p[3].black);
+		__m128i kings = _mm_setr_epi32((int)p[0].kings, (int)p[1].kings, (int)p[2].kings, (int)p[3].kings);
+		__m128i stones = _mm_or_si128(white, black);
+		__m128i sum = _mm_setzero_si128();
+		for (int square = PLAYABLE_CELLS - 1; square >= 0 && !_mm_testz_si128(stones, stones); square--) { // until no lane has a stone left
+			const __m128 whiteValue = _mm_blendv_ps(_mm_castsi128_ps(_mm_set1_epi32(weights.whiteMan[square])),
+				_mm_castsi128_ps(_mm_set1_epi32(weights.whiteKing[square])), _mm_castsi128_ps(kings));
+			const __m128 blackValue = _mm_blendv_ps(_mm_castsi128_ps(_mm_set1_epi32(weights.blackMan[square])),
+				_mm_castsi128_ps(_mm_set1_epi32(weights.blackKing[square])), _mm_castsi128_ps(kings));
+			const __m128i value = _mm_castps_si128(_mm_blendv_ps(whiteValue, blackValue, _mm_castsi128_ps(black)));
+			sum = _mm_add_epi32(sum, _mm_and_si128(value, _mm_srai_epi32(stones, 31)));
+			stones = _mm_slli_epi32(stones, 1);
+			black = _mm_slli_epi32(black, 1);
+			kings = _mm_slli_epi32(kings, 1);
+		}
+		_mm_storeu_si128((__m128i *)(scores + i), sum);
+	}
+	scoreScalar(positions + i, count - i, scores + i);
+}
+
+/**
+ * Scores 8 positions per step with AVX2, the last count % 8 with scorePosition.
+ * The bitboards are gathered straight from the array of positions.
+ */
+TARGET_AVX2 static void scoreAvx2(const S_Position *positions, int count, int *scores) {
+	static_assert(sizeof(S_Position) % sizeof(int) == 0, "the gather indexes count in ints");
+	const S_SquareWeights &weights = squareWeights();
+	const int stride = (int)(sizeof(S_Position) / sizeof(int));
+	const __m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const int *base = (const int *)(positions + i);
+		const __m256i white = _mm256_i32gather_epi32(base + offsetof(S_Position, white) / sizeof(int), index, sizeof(int));
+		__m256i black = _mm256_i32gather_epi32(base + offsetof(S_Position, black) / sizeof(int), index, sizeof(int));
+		__m256i kings = _mm256_i32gather_epi32(base + offsetof(S_Position, kings) / sizeof(int), index, sizeof(int));
+		__m256i stones = _mm256_or_si256(white, black);
+		__m256i sum = _mm256_setzero_si256();
+		for (int square = PLAYABLE_CELLS - 1; square >= 0 && !_mm256_testz_si256(stones, stones); square--) { // until no lane has a stone left
+			const __m256 whiteValue = _mm256_blendv_ps(_mm256_castsi256_ps(_mm256_set1_epi32(weights.whiteMan[square])),
+				_mm256_castsi256_ps(_mm256_set1_epi32(weights.whiteKing[square])), _mm256_castsi256_ps(kings));
+			const __m256 blackValue = _mm256_blendv_ps(_mm256_castsi256_ps(_mm256_set1_epi32(weights.blackMan[square])),
+				_mm256_castsi256_ps(_mm256_set1_epi32(weights.blackKing[square])), _mm256_castsi256_ps(kings));
+			const __m256i value = _mm256_castps_si256(_mm256_blendv_ps(whiteValue, blackValue, _mm256_castsi256_ps(black)));
+			sum = _mm256_add_epi32(sum, _mm256_and_si256(value, _mm256_srai_epi32(stones, 31)));
+			stones = _mm256_slli_epi32(stones, 1);
+			black = _mm256_slli_epi32(black, 1);
+			kings = _mm256_slli_epi32(kings, 1);
+		}
+		_mm256_storeu_si256((__m256i *)(scores + i), sum);
+	}
+	scoreScalar(positions + i, count - i, scores + i);
+}
+#endif
+
+/**
+ * Tells whether the processor and the operating system can run an instruction set.
+ * @param isa - The instruction set.
+ * @return true for EVAL_SCALAR, false for the SIMD ones on a processor that is not x86.
+ */
+bool evalIsaSupported(E_EvalIsa isa) {
+	if (isa == EVAL_SCALAR)
+		return true;
+#if defined(BATCH_EVAL_X86)
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	if (isa == EVAL_SSE41)
+		return (info[2] & (1 << 19)) != 0;
+	if (isa == EVAL_AVX2) {
+		const bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6; // OSXSAVE, AVX, and the OS saves the ymm registers
+		__cpuidex(info, 7, 0);
+		return osSavesYmm && (info[1] & (1 << 5)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	if (isa == EVAL_SSE41)
+		return __builtin_cpu_supports("sse4.1") != 0;
+	if (isa == EVAL_AVX2)
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+#endif
+	return false;
+}
+
+/**
+ * Returns the instruction set scorePositions uses: the best one the processor has, found on the first call.
+ */
+E_EvalIsa evalIsa() {
+	static const E_EvalIsa best = evalIsaSupported(EVAL_AVX2) ? EVAL_AVX2 : evalIsaSupported(EVAL_SSE41) ? EVAL_SSE41 : EVAL_SCALAR;
+	return best;
+}
+
+/**
+ * Returns the name of an instruction set, for printing.
+ */
+const char *evalIsaName(E_EvalIsa isa) {
+	static const char *const names[EVAL_ISAS] = { "scalar", "sse4.1", "avx2" };
+	return isa >= 0 && isa < EVAL_ISAS ? names[isa] : "unknown";
+}
+
+/**
+ * Evaluates many positions from scratch, as scorePosition does one, with the best instruction set of the processor.
+ * For leaves collected by a search, training data or analysis: the search itself reads the score applyMove keeps.
+ * @param positions - The positions, their score members are ignored.
+ * @param count - Number of positions.
+ * @param scores - Receives the score of every position from the COMPUTER's point of view, room for count.
+ */
+void scorePositions(const S_Position *positions, int count, int *scores) {
+	scorePositionsWith(evalIsa(), positions, count, scores);
+}
+
+/**
+ * Evaluates many positions with a given instruction set, to compare them.
+ * @param isa - The instruction set, evalIsaSupported must be true for it.
+ * @param positions - The positions, their score members are ignored.
+ * @param count - Number of positions.
+ * @param scores - Receives the scores, the same as scorePosition returns.
+ */
+void scorePositionsWith(E_EvalIsa isa, const S_Position *positions, int count, int *scores) {
+#if defined(BATCH_EVAL_X86)
+	if (isa == EVAL_AVX2) {
+		scoreAvx2(positions, count, scores);
+		return;
+	}
+	if (isa == EVAL_SSE41) {
+		scoreSse41(positions, count, scores);
+		return;
+	}
+#endif
+	scoreScalar(positions, count, scores);
+}
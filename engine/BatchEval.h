@@ -0,0 +1,24 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   BatchEval.h                                                              */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Evaluation of many positions at once with SIMD kernels,                  */
+/*   the instruction set picked when the program runs                         */
+/* ========================================================================== */
+#pragma once
+#include "Position.h"
+
+typedef enum
+{
+	EVAL_SCALAR = 0, // scorePosition on every position, runs everywhere
+	EVAL_SSE41 = 1, // 4 positions per step, x86 with SSE4.1
+	EVAL_AVX2 = 2, // 8 positions per step, x86 with AVX2
+	EVAL_ISAS = 3 // number of instruction sets
+} E_EvalIsa;
+
+void scorePositions(const S_Position *positions, int count, int *scores);
+void scorePositionsWith(E_EvalIsa isa, const S_Position *positions, int count, int *scores);
+bool evalIsaSupported(E_EvalIsa isa);
+E_EvalIsa evalIsa(); // the instruction set scorePositions uses, the best one the processor has
+const char *evalIsaName(E_EvalIsa isa);
@@ -0,0 +1,121 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Book.cpp                                                                 */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Opening book implementation                                              */
+/*   the lookup of a position's moves in the mapped file                      */
+/* ========================================================================== */
+
+#include "Book.h"
+#include "MappedFile.h"
+#include <string.h> // for memcpy
+
+static_assert(sizeof(S_BookHeader) == 16 && sizeof(S_BookEntry) == 16, "the book file is read in place, its layout must not change");
+
+S_Book::~S_Book() {
+	bookClose(*this);
+}
+
+/**
+ * Maps a book file into memory. Nothing is parsed: the entries are read in place by the lookups.
+ * @param book - Receives the mapping, the file it had is closed first.
+ * @param path - The file written by the bookgen tool.
+ * @return false when the file can not be opened or is not a book, book is then closed.
+ */
+bool bookOpen(S_Book &book, const char *path) {
+	bookClose(book);
+	if (!mapFile(path, book.data, book.size))
+		return false;
+	S_BookHeader header;
+	if (book.size < sizeof(header)) {
+		bookClose(book);
+		return false;
+	}
+	memcpy(&header, book.data, sizeof(header));
+	if (header.magic != BOOK_MAGIC || header.version != BOOK_VERSION || header.entryCount > (book.size - sizeof(header)) / sizeof(S_BookEntry)) {
+		bookClose(book);
+		return false;
+	}
+	book.entries = (const S_BookEntry *)(book.data + sizeof(header)); // the mapping is page aligned and the header is 16 bytes
+	book.count = (size_t)header.entryCount;
+	return true;
+}
+
+/**
+ * Unmaps the file, does nothing when none is open.
+ */
+void bookClose(S_Book &book) {
+	unmapFile(book.data, book.size);
+	book.data = NULL;
+	book.size = 0;
+	book.entries = NULL;
+	book.count = 0;
+}
+
+/**
+ * Finds the book moves of a position. Only legal moves are returned,
+ * so an entry of another position with the same hash is never played.
+ * @param book - An open book, or a closed one which has no moves.
+ * @param position - The position, position.turn is the side to move.
+ * @param moves - Receives the moves, room for MAX_MOVES.
+ * @param weights - Receives the weight of every move, room for MAX_MOVES.
+ * @return The number of moves, 0 when the position is not in the book.
+ */
+int bookMoves(const S_Book &book, const S_Position &position, S_Move *moves, int *weights) {
+	// First entry of the position
+	size_t low = 0, high = book.count;
+	while (low < high) {
+		const size_t middle = low + (high - low) / 2;
+		if (book.entries[middle].hash < position.hash)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	if (low == book.count || book.entries[low].hash != position.hash)
+		return 0;
+
+	S_MoveList legal;
+	generateMoves(position, position.turn, legal);
+	if (isThereAttackMoves(legal))
+		filterAttackMoves(legal);
+	int count = 0;
+	for (size_t i = low; i < book.count && book.entries[i].hash == position.hash; i++) {
+		const S_BookEntry &entry = book.entries[i];
+		for (int j = 0; j < legal.count; j++)
+			if (legal.moves[j].from == entry.from && legal.moves[j].to == entry.to && legal.moves[j].captured == entry.captured) {
+				if (entry.weight > 0 && count < MAX_MOVES) {
+					moves[count] = legal.moves[j];
+					weights[count] = entry.weight;
+					count++;
+				}
+				break;
+			}
+	}
+	return count;
+}
+
+/**
+ * Picks a book move of a position, each with a chance in proportion to its weight.
+ * @param book - An open book, or a closed one which has no moves.
+ * @param position - The position, position.turn is the side to move.
+ * @param random - Any random number, e.g. from rand(), it picks the move.
+ * @param move - Receives the move.
+ * @return false when the position is not in the book, the move must then be searched.
+ */
+bool bookProbe(const S_Book &book, const S_Position &position, unsigned int random, S_Move &move) {
+	S_Move moves[MAX_MOVES];
+	int weights[MAX_MOVES];
+	const int count = bookMoves(book, position, moves, weights);
+	if (count == 0)
+		return false;
+	int total = 0;
+	for (int i = 0; i < count; i++)
+		total += weights[i];
+	int pick = (int)(random % (unsigned int)total);
+	int i = 0;
+	while (pick >= weights[i])
+		pick -= weights[i++];
+	move = moves[i];
+	return true;
+}
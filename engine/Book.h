@@ -0,0 +1,54 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Book.h                                                                   */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Opening book: weighted moves of the positions of recorded games,         */
+/*   looked up in a memory-mapped file instead of searching them              */
+/* ========================================================================== */
+#pragma once
+#include "Position.h"
+#include <stddef.h> // for size_t
+
+#define BOOK_MAGIC 0x4B4F4F42u /* "BOOK" read as a little endian int */
+#define BOOK_VERSION 1
+#define BOOK_MAX_WEIGHT 65535 /* an entry's weight is kept in 16 bits */
+
+/*
+ * File layout, little endian:
+ *   S_BookHeader
+ *   S_BookEntry entries[entryCount]  sorted by hash, the moves of one position next to each other
+ * The entries are read in place from the mapped file, a lookup is a binary search on the hash.
+ * The hash is the Zobrist key of S_Position, which is the same in every build.
+ */
+struct S_BookHeader
+{
+	unsigned int magic; // BOOK_MAGIC
+	unsigned int version; // BOOK_VERSION
+	unsigned long long entryCount;
+};
+
+struct S_BookEntry /* one move of a position, 16 bytes */
+{
+	unsigned long long hash; // Zobrist key of the position the move is played in
+	Bitboard captured; // as in S_Move, tells apart two captures between the same squares
+	unsigned char from, to;
+	unsigned short weight; // how often the move is played, relative to the other moves of the position
+};
+
+struct S_Book /* a book file mapped into memory */
+{
+	S_Book() : data(NULL), size(0), entries(NULL), count(0) {}
+	~S_Book();
+	S_Book(const S_Book &) = delete;
+	S_Book &operator=(const S_Book &) = delete;
+	const unsigned char *data; // the whole file, NULL when none is open
+	size_t size;
+	const S_BookEntry *entries; // right after the header in data
+	size_t count;
+};
+
+bool bookOpen(S_Book &book, const char *path);
+void bookClose(S_Book &book);
+int bookMoves(const S_Book &book, const S_Position &position, S_Move *moves, int *weights);
+bool bookProbe(const S_Book &book, const S_Position &position, unsigned int random, S_Move &move);
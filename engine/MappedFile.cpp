@@ -0,0 +1,76 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   MappedFile.cpp                                                           */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Memory mapping of read-only files                                        */
+/*   with the Windows and the POSIX calls                                     */
+/* ========================================================================== */
+
+#include "MappedFile.h"
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Maps a whole file into memory, read-only. Nothing is read: the pages are loaded when they are first touched.
+ * @param path - The file.
+ * @param data - Receives the first byte of the file, NULL when it can not be mapped.
+ * @param size - Receives the size of the file in bytes, 0 when it can not be mapped.
+ * @return false when the file does not exist, is empty or can not be mapped.
+ */
+bool mapFile(const char *path, const unsigned char *&data, size_t &size) {
+	data = NULL;
+	size = 0;
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	CloseHandle(file);
+	if (!mapping)
+		return false;
+	const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping); // the view keeps the mapping open
+	if (!view)
+		return false;
+	data = (const unsigned char *)view;
+	size = (size_t)fileSize.QuadPart;
+#else
+	const int file = open(path, O_RDONLY);
+	if (file < 0)
+		return false;
+	struct stat status;
+	void *view = MAP_FAILED;
+	if (fstat(file, &status) == 0 && status.st_size > 0)
+		view = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+	close(file); // the mapping stays valid
+	if (view == MAP_FAILED)
+		return false;
+	data = (const unsigned char *)view;
+	size = (size_t)status.st_size;
+#endif
+	return true;
+}
+
+/**
+ * Unmaps a file mapped by mapFile, does nothing for NULL.
+ * @param data - The first byte of the mapping.
+ * @param size - Its size.
+ */
+void unmapFile(const unsigned char *data, size_t size) {
+	if (!data)
+		return;
+#if defined(_WIN32)
+	UnmapViewOfFile(data);
+#else
+	munmap((void *)data, size);
+#endif
+}
@@ -0,0 +1,13 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   MappedFile.h                                                             */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Read-only files mapped into memory, for the tablebase and the book       */
+/*   which are read in place, without parsing them at startup                 */
+/* ========================================================================== */
+#pragma once
+#include <stddef.h> // for size_t
+
+bool mapFile(const char *path, const unsigned char *&data, size_t &size);
+void unmapFile(const unsigned char *data, size_t size);
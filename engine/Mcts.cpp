@@ -0,0 +1,403 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Mcts.cpp                                                                 */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Monte Carlo tree search implementation                                   */
+/*   one shared tree, playouts run outside of its lock                        */
+/* ========================================================================== */
+
+#include "Mcts.h"
+#include <math.h>
+#include <thread>
+#include <chrono>
+
+/**
+ * xorshift64 step: fast, good enough for playouts, and every thread has its own state, unlike rand().
+ * @param state - Generator state, never 0, advanced.
+ * @return A random number, the high 32 bits of the new state.
+ */
+static inline unsigned int nextRandom(unsigned long long &state) {
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return (unsigned int)(state >> 32);
+}
+
+/**
+ * Returns a random number below bound, without the bias nor the division of a modulo.
+ */
+static inline int randomBelow(unsigned long long &state, int bound) {
+	return (int)(((unsigned long long)nextRandom(state) * (unsigned int)bound) >> 32);
+}
+
+/**
+ * Generates the legal moves of the side to move, only the captures when there is one.
+ * @param position - The current position.
+ * @param moves - Receives the moves.
+ */
+static void legalMoves(const S_Position &position, S_MoveList &moves) {
+	generateMoves(position, position.turn, moves);
+	if (isThereAttackMoves(moves))
+		filterAttackMoves(moves);
+}
+
+/**
+ * Picks the move of a light playout: a crowning move weighs 5, a capture 1 plus 2 per jumped stone, other moves 1.
+ * @param position - The position, position.turn moves.
+ * @param moves - Its legal moves, not empty.
+ * @param rng - Generator state of the thread.
+ * @return Index of the picked move.
+ */
+static int pickLightMove(const S_Position &position, const S_MoveList &moves, unsigned long long &rng) {
+	const Bitboard kingsRow = position.turn == COMPUTER ? BLACK_KINGS_ROW : WHITE_KINGS_ROW;
+	int weights[MAX_MOVES];
+	int total = 0;
+	for (int i = 0; i < moves.count; i++) {
+		const S_Move &move = moves.moves[i];
+		int weight = 1 + 2 * move.attack;
+		if (!(position.kings & squareMask(move.from)) && (squareMask(move.to) & kingsRow))
+			weight += 4;
+		weights[i] = weight;
+		total += weight;
+	}
+	int pick = randomBelow(rng, total);
+	int i = 0;
+	while (pick >= weights[i])
+		pick -= weights[i++];
+	return i;
+}
+
+/**
+ * Plays random moves until a side has no move left, or MCTS_PLAYOUT_PLIES were played.
+ * A playout cut at the ply limit is won by the side ahead by at least a man, drawn otherwise.
+ * @param position - The position to play out, copied.
+ * @param light - Whether to pick the moves with pickLightMove instead of uniformly.
+ * @param rng - Generator state of the thread.
+ * @return The winner, EMPTY for a draw.
+ */
+static E_MoveTurn playout(S_Position position, bool light, unsigned long long &rng) {
+	for (int ply = 0; ply < MCTS_PLAYOUT_PLIES; ply++) {
+		S_MoveList moves;
+		legalMoves(position, moves);
+		if (moves.count == 0)
+			return position.turn == COMPUTER ? PLAYER : COMPUTER;
+		const int pick = light ? pickLightMove(position, moves, rng) : randomBelow(rng, moves.count);
+		S_Undo undo;
+		applyMove(position, moves.moves[pick], undo);
+	}
+	const int score = evaluateBoard(position);
+	if (score >= MAN_VALUE)
+		return COMPUTER;
+	if (score <= -MAN_VALUE)
+		return PLAYER;
+	return EMPTY;
+}
+
+/**
+ * UCT: picks the child with the best win rate plus exploration bonus, a child without playouts first.
+ * The playouts running through a child count as lost, so the threads spread over the tree.
+ * @param tree - The tree, locked by the caller.
+ * @param parent - Index of an expanded node with children.
+ * @return Index of the picked child.
+ */
+static int selectChild(const S_MctsTree &tree, int parent) {
+	const S_MctsNode &node = tree.nodes[parent];
+	const double logVisits = log((double)(node.visits + node.virtualLoss) + 1.0);
+	int best = node.firstChild;
+	double bestValue = -1.0;
+	for (int child = node.firstChild; child < node.firstChild + node.childCount; child++) {
+		const S_MctsNode &candidate = tree.nodes[child];
+		const unsigned int visits = candidate.visits + candidate.virtualLoss;
+		if (visits == 0)
+			return child;
+		const double value = candidate.wins / visits + MCTS_EXPLORATION * sqrt(logVisits / visits);
+		if (value > bestValue) {
+			bestValue = value;
+			best = child;
+		}
+	}
+	return best;
+}
+
+/**
+ * Adds the children of a leaf, one per legal move. Nothing happens when the pool has no room left,
+ * the leaf stays a leaf and its playouts start from it.
+ * @param tree - The tree, locked by the caller.
+ * @param index - Index of a node that was not expanded.
+ * @param position - The position of the node.
+ */
+static void expandNode(S_MctsTree &tree, int index, const S_Position &position) {
+	S_MoveList moves;
+	legalMoves(position, moves);
+	if (tree.nodeCount + moves.count > (int)tree.nodes.size())
+		return;
+	S_MctsNode &node = tree.nodes[index];
+	node.firstChild = tree.nodeCount;
+	node.childCount = (unsigned short)moves.count;
+	for (int i = 0; i < moves.count; i++) {
+		S_MctsNode &child = tree.nodes[tree.nodeCount++];
+		child.move = moves.moves[i];
+		child.parent = index;
+		child.firstChild = -1;
+		child.childCount = 0;
+		child.mover = (unsigned char)position.turn;
+		child.virtualLoss = 0;
+		child.visits = 0;
+		child.wins = 0.0f;
+	}
+}
+
+/**
+ * One iteration of the search: walks down the tree, expands the leaf, plays it out and adds the result to the path.
+ * Only the walk and the update hold the lock.
+ * @param tree - The tree, its root is set.
+ * @param light - Whether the playout uses the light policy.
+ * @param rng - Generator state of the thread.
+ */
+static void runPlayout(S_MctsTree &tree, bool light, unsigned long long &rng) {
+	S_Position board;
+	int leaf;
+	E_MoveTurn winner = EMPTY;
+	bool decided = false; // the leaf is a position where the side to move has no move left
+	{
+		std::lock_guard<std::mutex> guard(tree.lock);
+		board = tree.rootPosition;
+		leaf = tree.root;
+		while (tree.nodes[leaf].firstChild >= 0 && tree.nodes[leaf].childCount > 0) {
+			leaf = selectChild(tree, leaf);
+			S_Undo undo;
+			applyMove(board, tree.nodes[leaf].move, undo);
+		}
+		if (tree.nodes[leaf].firstChild < 0) {
+			expandNode(tree, leaf, board);
+			const S_MctsNode &node = tree.nodes[leaf];
+			if (node.firstChild >= 0 && node.childCount > 0) {
+				leaf = node.firstChild + randomBelow(rng, node.childCount);
+				S_Undo undo;
+				applyMove(board, tree.nodes[leaf].move, undo);
+			}
+		}
+		if (tree.nodes[leaf].firstChild >= 0 && tree.nodes[leaf].childCount == 0) {
+			winner = (E_MoveTurn)tree.nodes[leaf].mover;
+			decided = true;
+		}
+		for (int index = leaf; index >= 0; index = tree.nodes[index].parent)
+			tree.nodes[index].virtualLoss++;
+	}
+
+	if (!decided)
+		winner = playout(board, light, rng);
+
+	std::lock_guard<std::mutex> guard(tree.lock);
+	for (int index = leaf; index >= 0; index = tree.nodes[index].parent) {
+		S_MctsNode &step = tree.nodes[index];
+		step.virtualLoss--;
+		step.visits++;
+		if (winner == EMPTY)
+			step.wins += 0.5f;
+		else if (winner == step.mover)
+			step.wins += 1.0f;
+	}
+}
+
+/**
+ * Makes the tree a single root node.
+ */
+static void newRoot(S_MctsTree &tree, const S_Position &position) {
+	S_MctsNode &root = tree.nodes[0];
+	root.move = S_Move();
+	root.parent = -1;
+	root.firstChild = -1;
+	root.childCount = 0;
+	root.mover = (unsigned char)(position.turn == COMPUTER ? PLAYER : COMPUTER);
+	root.virtualLoss = 0;
+	root.visits = 0;
+	root.wins = 0.0f;
+	tree.nodeCount = 1;
+	tree.root = 0;
+	tree.rootPosition = position;
+}
+
+static bool samePosition(const S_Position &a, const S_Position &b) {
+	return a.hash == b.hash && a.white == b.white && a.black == b.black && a.kings == b.kings && a.turn == b.turn;
+}
+
+/**
+ * Looks for the position in the first two plies of the tree: the root itself when it is searched again,
+ * a grandchild after the computer's move and the opponent's reply.
+ * @param tree - The tree of the last search.
+ * @param position - The position to search now.
+ * @return Index of the node of the position, -1 when the tree does not have it.
+ */
+static int findNode(const S_MctsTree &tree, const S_Position &position) {
+	if (tree.root < 0)
+		return -1;
+	if (samePosition(tree.rootPosition, position))
+		return tree.root;
+	const S_MctsNode &root = tree.nodes[tree.root];
+	if (root.firstChild < 0)
+		return -1;
+	for (int child = root.firstChild; child < root.firstChild + root.childCount; child++) {
+		S_Position board = tree.rootPosition;
+		S_Undo undo;
+		applyMove(board, tree.nodes[child].move, undo);
+		if (samePosition(board, position))
+			return child;
+		const S_MctsNode &node = tree.nodes[child];
+		if (node.firstChild < 0)
+			continue;
+		for (int grandchild = node.firstChild; grandchild < node.firstChild + node.childCount; grandchild++) {
+			S_Position reply = board;
+			applyMove(reply, tree.nodes[grandchild].move, undo);
+			if (samePosition(reply, position))
+				return grandchild;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Keeps only the subtree of a node, moved to the front of the pool with the node as root.
+ * The nodes are copied breadth first into the spare pool, a block of children at a time so they stay consecutive.
+ * Until a copied node is reached its firstChild still indexes the old pool.
+ * @param tree - The tree, not being searched.
+ * @param index - Index of the new root.
+ */
+static void keepSubtree(S_MctsTree &tree, int index) {
+	std::vector<S_MctsNode> &kept = tree.spare;
+	kept[0] = tree.nodes[index];
+	kept[0].parent = -1;
+	int count = 1;
+	for (int i = 0; i < count; i++) {
+		S_MctsNode &node = kept[i];
+		if (node.firstChild < 0)
+			continue;
+		const int oldFirst = node.firstChild;
+		node.firstChild = count;
+		for (int child = 0; child < node.childCount; child++) {
+			kept[count] = tree.nodes[oldFirst + child];
+			kept[count].parent = i;
+			count++;
+		}
+	}
+	tree.nodes.swap(tree.spare);
+	tree.nodeCount = count;
+	tree.root = 0;
+}
+
+/**
+ * Throws the tree away, the next search starts from an empty one. The pools stay allocated.
+ * @param tree - A tree that is not being searched.
+ */
+void mctsClear(S_MctsTree &tree) {
+	tree.nodeCount = 0;
+	tree.root = -1;
+}
+
+/**
+ * Searches the position with Monte Carlo tree search until the time or playout budget is used or it is cancelled.
+ * The tree of the last search is kept when it has the position within its first two plies, so the playouts
+ * spent on the move the opponent really played are not lost. The nodes come from a pool allocated by the
+ * first search, once it is full the leaves are played out without being expanded.
+ * Every thread walks the shared tree under its lock, then plays out on its own board without it.
+ * At least one playout is made unless the search is cancelled first, so there is a move even with a budget of 0.
+ * @param position - The position to search, position.turn is the side to move.
+ * @param limits - Budgets, threads, playout policy and cancel flag of the search.
+ * @param tree - Tree kept between searches, no other search may use it meanwhile.
+ * @return The most played move and the most played line after it as pv, depth is the length of the pv,
+ *         score is the win rate of the move scaled to -MCTS_SCORE_SCALE..MCTS_SCORE_SCALE,
+ *         stats.nodes is the number of playouts of this search.
+ *         pvLength is 0 when the side to move has no legal moves or the search was cancelled before any playout.
+ *         When there is a single legal move it is returned right away with depth 0.
+ */
+S_SearchResult mctsSearch(const S_Position &position, const S_MctsLimits &limits, S_MctsTree &tree) {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const std::chrono::steady_clock::time_point deadline = start + std::chrono::milliseconds(limits.milliseconds < 0 ? 0 : limits.milliseconds);
+	S_SearchResult result;
+	result.depth = 0;
+	result.pvLength = 0;
+	result.score = 0;
+
+	if (tree.nodes.empty()) {
+		tree.nodes.resize(MCTS_MAX_NODES);
+		tree.spare.resize(MCTS_MAX_NODES);
+	}
+	const int found = findNode(tree, position);
+	if (found < 0)
+		newRoot(tree, position);
+	else if (found != tree.root) {
+		keepSubtree(tree, found);
+		tree.rootPosition = position;
+	}
+
+	// No choice to make, do not spend the budget on it
+	S_MoveList moves;
+	legalMoves(position, moves);
+	if (moves.count == 0) {
+		result.score = -MCTS_SCORE_SCALE;
+		return result;
+	}
+	if (moves.count == 1) {
+		result.move = result.pv[0] = moves.moves[0];
+		result.pvLength = 1;
+		return result;
+	}
+
+	std::atomic<int> started(0); // playouts begun, to stop at the playout budget
+	std::atomic<int> played(0);
+	std::atomic<bool> stop(false);
+	const bool light = limits.lightPlayouts;
+	auto work = [&](unsigned long long rng) {
+		while (!stop.load(std::memory_order_relaxed)) {
+			if ((limits.cancel && limits.cancel->load(std::memory_order_relaxed))
+				|| (limits.milliseconds >= 0 && std::chrono::steady_clock::now() >= deadline)
+				|| (limits.playouts > 0 && started.fetch_add(1, std::memory_order_relaxed) >= limits.playouts)) {
+				stop = true;
+				break;
+			}
+			runPlayout(tree, light, rng);
+			played.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+	unsigned long long rng = (position.hash ^ 0x9E3779B97F4A7C15ull) | 1;
+	if (!(limits.cancel && limits.cancel->load(std::memory_order_relaxed))) {
+		runPlayout(tree, light, rng);
+		played++;
+		started++;
+	}
+	std::vector<std::thread> threads;
+	for (int i = 1; i < limits.threads; i++)
+		threads.push_back(std::thread(work, (position.hash * (2 * i + 1) ^ 0x9E3779B97F4A7C15ull) | 1));
+	work(rng);
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+	result.stats.nodes = played;
+
+	// The most played line, the win rates of little played nodes mean little
+	int index = tree.root;
+	float moveWins = 0.0f;
+	unsigned int moveVisits = 0;
+	while (result.pvLength < MAX_PLY && tree.nodes[index].firstChild >= 0) {
+		const S_MctsNode &node = tree.nodes[index];
+		int best = -1;
+		for (int child = node.firstChild; child < node.firstChild + node.childCount; child++)
+			if (tree.nodes[child].visits > 0 && (best < 0 || tree.nodes[child].visits > tree.nodes[best].visits))
+				best = child;
+		if (best < 0)
+			break;
+		if (result.pvLength == 0) {
+			moveWins = tree.nodes[best].wins;
+			moveVisits = tree.nodes[best].visits;
+		}
+		result.pv[result.pvLength++] = tree.nodes[best].move;
+		index = best;
+	}
+	if (result.pvLength == 0)
+		return result;
+	result.move = result.pv[0];
+	result.depth = result.pvLength;
+	result.score = (int)((2.0 * moveWins / moveVisits - 1.0) * MCTS_SCORE_SCALE);
+	return result;
+}
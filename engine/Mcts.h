@@ -0,0 +1,54 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Mcts.h                                                                   */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Monte Carlo tree search of the computer's move                           */
+/*   with UCT selection and random playouts on all cores                      */
+/* ========================================================================== */
+#pragma once
+#include "Search.h" // for S_SearchResult
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+#define MCTS_MAX_NODES (1 << 19) /* nodes of the tree, allocated once, about 15 MB and as much for the spare pool */
+#define MCTS_EXPLORATION 1.4 /* UCT exploration constant, higher tries more moves */
+#define MCTS_PLAYOUT_PLIES 150 /* playouts longer than that are scored on the material */
+#define MCTS_SCORE_SCALE 1000 /* S_SearchResult score of a sure win, 0 is an even chance */
+
+struct S_MctsNode /* one position of the tree, reached by move from its parent */
+{
+	S_Move move; // move from the parent, not valid for the root
+	int parent; // index of the parent, -1 for the root
+	int firstChild; // index of the first child, the children are consecutive, -1 until expanded
+	unsigned short childCount; // 0 once expanded when the side to move has no move (lost)
+	unsigned char mover; // side that played move
+	unsigned char virtualLoss; // playouts running through the node, counted as lost so other threads pick other nodes
+	unsigned int visits; // playouts through the node
+	float wins; // results of those playouts for mover, 1 a win and 0.5 a draw
+};
+
+struct S_MctsTree /* tree kept between the computer's moves, so the playouts of the last move are reused */
+{
+	S_MctsTree() : nodeCount(0), root(-1) {}
+	std::vector<S_MctsNode> nodes; // MCTS_MAX_NODES nodes once the first search started
+	std::vector<S_MctsNode> spare; // the nodes are compacted into it when the tree moves on, then swapped
+	int nodeCount; // nodes in use
+	int root; // index of the root, -1 for an empty tree
+	S_Position rootPosition;
+	std::mutex lock; // held by a search thread while it walks the tree, not while it plays out
+};
+
+struct S_MctsLimits /* when mctsSearch stops, and with how many threads */
+{
+	S_MctsLimits() : milliseconds(-1), playouts(0), threads(1), lightPlayouts(true), cancel(NULL) {}
+	int milliseconds; // time budget, -1 for none
+	int playouts; // playouts budget, 0 for none, without any budget the search runs until cancelled
+	int threads; // threads playing out at the same time, at least 1
+	bool lightPlayouts; // playouts prefer crowning and longer captures, otherwise they are uniformly random
+	const std::atomic<bool> *cancel; // flag another thread sets to stop the search, NULL when it can not be cancelled
+};
+
+void mctsClear(S_MctsTree &tree);
+S_SearchResult mctsSearch(const S_Position &position, const S_MctsLimits &limits, S_MctsTree &tree);
@@ -0,0 +1,194 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Network.cpp                                                              */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Neural network evaluation implementation: loading the weights,          */
+/*   the accumulator updates and the inference, with an AVX2 kernel           */
+/* ========================================================================== */
+
+#include "Network.h"
+#include <stdio.h>
+#include <string.h> // for memcpy
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define NETWORK_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+/**
+ * Reads the weights of a network file, written by the nntrain tool.
+ * @param network - Receives the weights, not valid when the call fails.
+ * @param path - The file.
+ * @return false when the file can not be read or is not a network of this size.
+ */
+bool nnLoad(S_Network &network, const char *path) {
+	FILE *file = fopen(path, "rb");
+	if (!file)
+		return false;
+	S_NnHeader header;
+	bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == NN_MAGIC && header.version == NN_VERSION
+		&& header.inputs == NN_INPUTS && header.hidden == NN_HIDDEN && header.hidden2 == NN_HIDDEN2;
+	// every member on its own, so the padding of the struct never reaches the file
+	valid = valid && fread(network.inputWeights, sizeof(network.inputWeights), 1, file) == 1
+		&& fread(network.inputBias, sizeof(network.inputBias), 1, file) == 1
+		&& fread(network.hiddenWeights, sizeof(network.hiddenWeights), 1, file) == 1
+		&& fread(network.hiddenBias, sizeof(network.hiddenBias), 1, file) == 1
+		&& fread(network.outputWeights, sizeof(network.outputWeights), 1, file) == 1
+		&& fread(network.outputBias, sizeof(network.outputBias), 1, file) == 1
+		&& fgetc(file) == EOF;
+	fclose(file);
+	return valid;
+}
+
+/**
+ * Computes the accumulator of a position from scratch: the bias and the rows of all its stones.
+ * @param network - The weights.
+ * @param position - The position.
+ * @param accumulator - Receives the first layer of the position.
+ */
+void nnRefresh(const S_Network &network, const S_Position &position, S_Accumulator &accumulator) {
+	memcpy(accumulator.values, network.inputBias, sizeof(accumulator.values));
+	for (Bitboard stones = position.white | position.black; stones; stones &= stones - 1) {
+		const int square = lowestSquare(stones);
+		const short *row = network.inputWeights[nnFeature((position.black & squareMask(square)) ? COMPUTER : PLAYER,
+			(position.kings & squareMask(square)) != 0, square)];
+		for (int i = 0; i < NN_HIDDEN; i++)
+			accumulator.values[i] += row[i];
+	}
+}
+
+/**
+ * Computes the accumulator after a move from the one before it, as applyMove changes the score:
+ * the row of the stone leaving its square is taken out, the row of the stone landing
+ * (crowned when it reached the last row) is added, and the rows of the captured stones are taken out.
+ * @param network - The weights.
+ * @param position - The position before the move.
+ * @param move - A legal move of the position.
+ * @param before - The accumulator of the position.
+ * @param after - Receives the accumulator of the position after the move, may not be before.
+ */
+void nnUpdate(const S_Network &network, const S_Position &position, const S_Move &move, const S_Accumulator &before, S_Accumulator &after) {
+	const bool black = (position.black & squareMask(move.from)) != 0;
+	const int side = black ? COMPUTER : PLAYER;
+	const bool king = (position.kings & squareMask(move.from)) != 0;
+	const bool crowned = king || (squareMask(move.to) & (black ? BLACK_KINGS_ROW : WHITE_KINGS_ROW)) != 0;
+	const short *leave = network.inputWeights[nnFeature(side, king, move.from)];
+	const short *land = network.inputWeights[nnFeature(side, crowned, move.to)];
+	for (int i = 0; i < NN_HIDDEN; i++)
+		after.values[i] = (short)(before.values[i] - leave[i] + land[i]);
+	for (Bitboard captured = move.captured; captured; captured &= captured - 1) {
+		const int square = lowestSquare(captured);
+		const short *row = network.inputWeights[nnFeature(black ? PLAYER : COMPUTER, (position.kings & squareMask(square)) != 0, square)];
+		for (int i = 0; i < NN_HIDDEN; i++)
+			after.values[i] -= row[i];
+	}
+}
+
+/**
+ * Clipped ReLU of a layer: between 0 and NN_ACTIVATION_SCALE.
+ */
+static inline int clipActivation(int value) {
+	return value < 0 ? 0 : value > NN_ACTIVATION_SCALE ? NN_ACTIVATION_SCALE : value;
+}
+
+/**
+ * Output of the network from its second layer, in evaluation units and clamped to NN_MAX_SCORE.
+ */
+static int outputScore(const S_Network &network, const int *hidden, int turn) {
+	int output = network.outputBias[turn == COMPUTER ? 1 : 0];
+	for (int j = 0; j < NN_HIDDEN2; j++)
+		output += hidden[j] * network.outputWeights[j];
+	const long long score = (long long)output * MAN_VALUE / (NN_ACTIVATION_SCALE * NN_OUTPUT_SCALE);
+	return score > NN_MAX_SCORE ? NN_MAX_SCORE : score < -NN_MAX_SCORE ? -NN_MAX_SCORE : (int)score;
+}
+
+/**
+ * Runs the layers after the accumulator one value at a time, on any processor.
+ */
+static int evaluateScalar(const S_Network &network, const S_Accumulator &accumulator, int turn) {
+	unsigned char activations[NN_HIDDEN];
+	for (int i = 0; i < NN_HIDDEN; i++)
+		activations[i] = (unsigned char)clipActivation(accumulator.values[i]);
+	int hidden[NN_HIDDEN2];
+	for (int j = 0; j < NN_HIDDEN2; j++) {
+		int sum = network.hiddenBias[j];
+		for (int i = 0; i < NN_HIDDEN; i++)
+			sum += activations[i] * network.hiddenWeights[j][i];
+		hidden[j] = clipActivation(sum >> NN_HIDDEN_SHIFT);
+	}
+	return outputScore(network, hidden, turn);
+}
+
+#if defined(NETWORK_X86)
+/**
+ * Runs the layers after the accumulator with AVX2: the activations are packed to bytes and
+ * every neuron of the second layer multiplies 32 of them by its int8 weights in one instruction.
+ */
+TARGET_AVX2 static int evaluateAvx2(const S_Network &network, const S_Accumulator &accumulator, int turn) {
+	static_assert(NN_HIDDEN == 64 && NN_HIDDEN2 % 8 == 0, "the kernel packs the accumulator into two vectors of 32 bytes");
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i top = _mm256_set1_epi16(NN_ACTIVATION_SCALE);
+	__m256i packed[2];
+	for (int half = 0; half < 2; half++) {
+		const __m256i low = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256((const __m256i *)(accumulator.values + half * 32)), zero), top);
+		const __m256i high = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256((const __m256i *)(accumulator.values + half * 32 + 16)), zero), top);
+		packed[half] = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8); // packus interleaves the 128 bit lanes
+	}
+
+	const __m256i ones = _mm256_set1_epi16(1);
+	int hidden[NN_HIDDEN2];
+	for (int j = 0; j < NN_HIDDEN2; j += 8) {
+		__m256i sums[8];
+		for (int k = 0; k < 8; k++) {
+			const signed char *weights = network.hiddenWeights[j + k];
+			// maddubs sums two products in int16, 2 * 127 * 127 fits, four would not: each half is widened to int32 before they are added
+			const __m256i low = _mm256_madd_epi16(_mm256_maddubs_epi16(packed[0], _mm256_loadu_si256((const __m256i *)weights)), ones);
+			const __m256i high = _mm256_madd_epi16(_mm256_maddubs_epi16(packed[1], _mm256_loadu_si256((const __m256i *)(weights + 32))), ones);
+			sums[k] = _mm256_add_epi32(low, high);
+		}
+		// sum the 8 lanes of the 8 neurons into one vector
+		const __m256i s01 = _mm256_hadd_epi32(sums[0], sums[1]), s23 = _mm256_hadd_epi32(sums[2], sums[3]);
+		const __m256i s45 = _mm256_hadd_epi32(sums[4], sums[5]), s67 = _mm256_hadd_epi32(sums[6], sums[7]);
+		const __m256i s0123 = _mm256_hadd_epi32(s01, s23), s4567 = _mm256_hadd_epi32(s45, s67);
+		__m256i total = _mm256_add_epi32(_mm256_permute2x128_si256(s0123, s4567, 0x20), _mm256_permute2x128_si256(s0123, s4567, 0x31));
+		total = _mm256_add_epi32(total, _mm256_loadu_si256((const __m256i *)(network.hiddenBias + j)));
+		total = _mm256_srai_epi32(total, NN_HIDDEN_SHIFT);
+		total = _mm256_min_epi32(_mm256_max_epi32(total, zero), _mm256_set1_epi32(NN_ACTIVATION_SCALE));
+		_mm256_storeu_si256((__m256i *)(hidden + j), total);
+	}
+	return outputScore(network, hidden, turn);
+}
+#endif
+
+/**
+ * Evaluates a position from its accumulator, with AVX2 when the processor has it.
+ * @param network - The weights.
+ * @param accumulator - The accumulator of the position, from nnRefresh or nnUpdate.
+ * @param turn - The side to move of the position.
+ * @return The evaluation from the COMPUTER's point of view, positive when the COMPUTER is ahead, like evaluateBoard.
+ */
+int nnEvaluate(const S_Network &network, const S_Accumulator &accumulator, int turn) {
+	return nnEvaluateWith(evalIsa(), network, accumulator, turn);
+}
+
+/**
+ * Evaluates a position from its accumulator with a given instruction set, to compare them.
+ * @param isa - The instruction set, evalIsaSupported must be true for it. There is no SSE4.1 kernel, it runs the scalar one.
+ * @param network - The weights.
+ * @param accumulator - The accumulator of the position.
+ * @param turn - The side to move of the position.
+ * @return The same evaluation as nnEvaluate.
+ */
+int nnEvaluateWith(E_EvalIsa isa, const S_Network &network, const S_Accumulator &accumulator, int turn) {
+#if defined(NETWORK_X86)
+	if (isa == EVAL_AVX2)
+		return evaluateAvx2(network, accumulator, turn);
+#endif
+	return evaluateScalar(network, accumulator, turn);
+}
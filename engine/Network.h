@@ -0,0 +1,64 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Network.h                                                                */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Small quantised neural network evaluation, its first layer               */
+/*   kept up to date move by move in an accumulator                           */
+/* ========================================================================== */
+#pragma once
+#include "Position.h"
+#include "BatchEval.h" // for E_EvalIsa, the instruction set of the inference
+
+#define NN_MAGIC 0x4E4E4B43u /* "CKNN" read as a little endian int */
+#define NN_VERSION 1
+#define NN_INPUTS 128 /* one per kind of stone (white man, white king, black man, black king) and square */
+#define NN_HIDDEN 64 /* first layer, the accumulator */
+#define NN_HIDDEN2 32 /* second layer */
+#define NN_ACTIVATION_SCALE 127 /* an activation of 1.0, the clipped ReLU keeps the layers between 0 and it */
+#define NN_HIDDEN_SHIFT 6 /* the second layer's weights are 64 times the trained ones */
+#define NN_OUTPUT_SCALE 256 /* the output weights are that many times the trained ones */
+#define NN_MAX_SCORE 10000 /* evaluations are clamped to it, far from the win scores */
+
+/*
+ * The network scores a position from the COMPUTER's point of view, in the units of evaluateBoard:
+ *   inputs (1 for every stone) -> NN_HIDDEN int16 -> clipped ReLU -> NN_HIDDEN2 (int8 weights) -> clipped ReLU
+ *   -> output (int16 weights, a bias for each side to move), trained in men and multiplied by MAN_VALUE.
+ * The first layer is the sum of the inputWeights rows of the stones on the board, so a move only
+ * subtracts the rows of the stones it takes away and adds the row of the stone where it lands (nnUpdate).
+ *
+ * File layout, little endian: S_NnHeader, then the members of S_Network from inputWeights to outputBias, in order.
+ */
+struct S_NnHeader
+{
+	unsigned int magic; // NN_MAGIC
+	unsigned int version; // NN_VERSION
+	unsigned int inputs, hidden, hidden2; // NN_INPUTS, NN_HIDDEN, NN_HIDDEN2
+	unsigned int reserved;
+};
+
+struct S_Network /* the weights, read by every search thread */
+{
+	short inputWeights[NN_INPUTS][NN_HIDDEN]; // times NN_ACTIVATION_SCALE
+	short inputBias[NN_HIDDEN]; // times NN_ACTIVATION_SCALE
+	signed char hiddenWeights[NN_HIDDEN2][NN_HIDDEN]; // times 1 << NN_HIDDEN_SHIFT
+	int hiddenBias[NN_HIDDEN2]; // times NN_ACTIVATION_SCALE << NN_HIDDEN_SHIFT
+	short outputWeights[NN_HIDDEN2]; // times NN_OUTPUT_SCALE
+	int outputBias[2]; // by side to move, times NN_ACTIVATION_SCALE * NN_OUTPUT_SCALE
+};
+
+struct S_Accumulator /* first layer of one position, before the activation */
+{
+	short values[NN_HIDDEN];
+};
+
+inline int nnFeature(int turn, bool king, int square) /* input of a stone */
+{
+	return ((turn == COMPUTER ? 2 : 0) + (king ? 1 : 0)) * PLAYABLE_CELLS + square;
+}
+
+bool nnLoad(S_Network &network, const char *path);
+void nnRefresh(const S_Network &network, const S_Position &position, S_Accumulator &accumulator);
+void nnUpdate(const S_Network &network, const S_Position &position, const S_Move &move, const S_Accumulator &before, S_Accumulator &after);
+int nnEvaluate(const S_Network &network, const S_Accumulator &accumulator, int turn);
+int nnEvaluateWith(E_EvalIsa isa, const S_Network &network, const S_Accumulator &accumulator, int turn);
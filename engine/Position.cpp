@@ -0,0 +1,508 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Position.cpp                                                             */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Move generation, evaluation and minimax                                  */
+/*   working on the bitboard position                                         */
+/* ========================================================================== */
+
+#include "Position.h"
+
+
+/*
+ * Neighbour and jump tables of every square, built at compile time.
+ * The four diagonal directions are in the order the moves are generated:
+ * 0, 1 go down the rows (COMPUTER men), 2, 3 go up the rows (PLAYER men), kings use all four.
+ * An entry is -1 when the move would leave the board.
+ */
+struct S_MoveTables
+{
+	signed char neighbour[PLAYABLE_CELLS][4]; // square one step away
+	signed char jump[PLAYABLE_CELLS][4]; // landing square when jumping over the neighbour
+
+	constexpr S_MoveTables() : neighbour(), jump()
+	{
+		const int directionRow[4] = { 1, 1, -1, -1 };
+		const int directionCol[4] = { 1, -1, 1, -1 };
+		for (int square = 0; square < PLAYABLE_CELLS; square++)
+			for (int direction = 0; direction < 4; direction++) {
+				const int row = square / 4;
+				const int col = (square % 4) * 2 + row % 2;
+				const int nextrow = row + directionRow[direction], nextcol = col + directionCol[direction];
+				const int jumprow = nextrow + directionRow[direction], jumpcol = nextcol + directionCol[direction];
+				neighbour[square][direction] = (nextrow >= 0 && nextrow < BOARD_ROWS && nextcol >= 0 && nextcol < BOARD_ROWS) ? (signed char)(nextrow * 4 + nextcol / 2) : -1;
+				jump[square][direction] = (jumprow >= 0 && jumprow < BOARD_ROWS && jumpcol >= 0 && jumpcol < BOARD_ROWS) ? (signed char)(jumprow * 4 + jumpcol / 2) : -1;
+			}
+	}
+};
+
+static constexpr S_MoveTables moveTables;
+static_assert(moveTables.neighbour[0][0] == 4 && moveTables.jump[0][0] == 9 && moveTables.neighbour[0][1] == -1, "square 0 is block (0, 0)");
+static_assert(moveTables.neighbour[31][3] == 27 && moveTables.jump[31][3] == 22 && moveTables.jump[31][2] == -1, "square 31 is block (7, 7)");
+
+/*
+ * Zobrist keys, built at compile time from a fixed seed so the keys are the same in every build.
+ * The key of a position is the xor of the keys of its stones, and of turnKey when COMPUTER is to move,
+ * so applyMove only has to xor in the few keys a move changes.
+ */
+enum E_StoneKind { WHITE_MAN, WHITE_KING, BLACK_MAN, BLACK_KING, STONE_KINDS };
+
+struct S_ZobristKeys
+{
+	unsigned long long stone[STONE_KINDS][PLAYABLE_CELLS];
+	unsigned long long turnKey; // xor-ed in when COMPUTER is to move
+
+	constexpr S_ZobristKeys() : stone(), turnKey(0)
+	{
+		unsigned long long seed = 2018;
+		for (int kind = 0; kind < STONE_KINDS; kind++)
+			for (int square = 0; square < PLAYABLE_CELLS; square++)
+				stone[kind][square] = next(seed);
+		turnKey = next(seed);
+	}
+
+	static constexpr unsigned long long next(unsigned long long &seed) // splitmix64
+	{
+		unsigned long long z = (seed += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+};
+
+static constexpr S_ZobristKeys zobrist;
+
+/*
+ * Evaluation of every kind of stone on every square from the COMPUTER's point of view, built at compile time.
+ * The score of a position is the sum over its stones, so applyMove only adds and takes out the stones a move changes.
+ */
+struct S_StoneValues
+{
+	int value[STONE_KINDS][PLAYABLE_CELLS];
+
+	constexpr S_StoneValues() : value()
+	{
+		for (int square = 0; square < PLAYABLE_CELLS; square++) {
+			const int row = square / 4;
+			value[WHITE_MAN][square] = -(MAN_VALUE + BOARD_ROWS - 1 - row); // men are worth more the further they advanced
+			value[WHITE_KING][square] = -KING_VALUE;
+			value[BLACK_MAN][square] = MAN_VALUE + row;
+			value[BLACK_KING][square] = KING_VALUE;
+		}
+	}
+};
+
+static constexpr S_StoneValues stoneValues;
+
+/**
+ * Computes the Zobrist key of a position from scratch.
+ * @param position - The position, its hash member is ignored.
+ * @return The key applyMove keeps up to date incrementally.
+ */
+unsigned long long hashPosition(const S_Position &position) {
+	unsigned long long hash = position.turn == COMPUTER ? zobrist.turnKey : 0;
+	for (Bitboard pieces = position.white | position.black; pieces; pieces &= pieces - 1) {
+		const int square = lowestSquare(pieces);
+		const int kind = ((position.black & squareMask(square)) ? BLACK_MAN : WHITE_MAN) + ((position.kings & squareMask(square)) ? 1 : 0);
+		hash ^= zobrist.stone[kind][square];
+	}
+	return hash;
+}
+
+/**
+ * Returns the position of a new game.
+ * COMPUTER (black) stones are on rows 0-2, PLAYER (white) stones are on rows 5-7.
+ * @return The initial position with PLAYER to move.
+ */
+S_Position initialPosition() {
+	S_Position position;
+	position.black = 0x00000FFF; // squares 0-11
+	position.white = 0xFFF00000; // squares 20-31
+	position.kings = 0;
+	position.turn = PLAYER;
+	position.hash = hashPosition(position);
+	position.score = scorePosition(position);
+	return position;
+}
+
+/**
+ * Adds a move between two squares to the end of a move list.
+ * @param moves - The list to add to.
+ * @return The new move, attack cleared.
+ */
+static inline S_Move &appendMove(S_MoveList &moves, int from, int to) {
+	assert(moves.count < MAX_MOVES);
+	S_Move &move = moves.moves[moves.count++];
+	move.from = (unsigned char)from;
+	move.to = (unsigned char)to;
+	move.attack = 0;
+	move.captured = 0;
+	return move;
+}
+
+/**
+ * Follows the jumps of one stone depth first and adds every complete jump sequence as one move.
+ * A sequence ends when the stone can not jump again, or when a man reaches the kings row.
+ * Jumped stones stay on the board until the turn ends, so they can neither be jumped twice nor landed on.
+ * @param moves - The list to add to.
+ * @param from - Square the stone started the turn on.
+ * @param square - Square the stone landed on after the last jump.
+ * @param first, last - Directions the stone may jump in, all four for a king.
+ * @param empty - Squares the stone may land on, the square it left included.
+ * @param opponent - Stones of the other side.
+ * @param crown - Kings row of the side when the stone is a man, 0 for a king.
+ * @param captured - Squares jumped so far.
+ * @param jumps - Number of squares jumped so far.
+ */
+static void appendJumps(S_MoveList &moves, int from, int square, int first, int last, Bitboard empty, Bitboard opponent, Bitboard crown, Bitboard captured, int jumps) {
+	if (!(crown & squareMask(square))) {
+		bool jumped = false;
+		for (int direction = first; direction < last; direction++) {
+			const int jump = moveTables.jump[square][direction];
+			if (jump < 0 || !(empty & squareMask(jump)))
+				continue; // out of bounds or the landing square is occupied
+			const Bitboard next = squareMask(moveTables.neighbour[square][direction]);
+			if (!(opponent & next) || (captured & next))
+				continue; // nothing to jump, or jumped already
+			appendJumps(moves, from, jump, first, last, empty, opponent, crown, captured | next, jumps + 1);
+			jumped = true;
+		}
+		if (jumped)
+			return;
+	}
+	S_Move &move = appendMove(moves, from, square);
+	move.attack = (unsigned char)jumps;
+	move.captured = captured;
+}
+
+/**
+ * Generates all possible moves for the given player.
+ * Men move forward only (COMPUTER down the rows, PLAYER up the rows), kings move in all four directions.
+ * A capture is generated as one move holding the whole jump sequence of the turn.
+ * @param position - The current position.
+ * @param turn - The player to generate moves for (PLAYER or COMPUTER).
+ * @param moves - Receives the moves, count is 0 if there are none.
+ */
+void generateMoves(const S_Position &position, int turn, S_MoveList &moves) {
+	moves.count = 0;
+
+	const Bitboard own = turn == COMPUTER ? position.black : position.white;
+	const Bitboard occupied = position.black | position.white;
+	const Bitboard opponent = occupied & ~own;
+	const int manFirst = turn == COMPUTER ? 0 : 2; // first forward direction of a man
+	const Bitboard kingsRow = turn == COMPUTER ? BLACK_KINGS_ROW : WHITE_KINGS_ROW;
+
+	Bitboard pieces = own;
+	while (pieces) {
+		const int square = lowestSquare(pieces);
+		pieces &= pieces - 1;
+		const bool king = (position.kings & squareMask(square)) != 0;
+		const int first = king ? 0 : manFirst;
+		const int last = king ? 4 : manFirst + 2;
+
+		for (int direction = first; direction < last; direction++) {
+			const int next = moveTables.neighbour[square][direction];
+			if (next < 0)
+				continue; // out of bounds
+			if (!(occupied & squareMask(next))) { // if not blocked
+				appendMove(moves, square, next);
+			} else if (opponent & squareMask(next)) { // if blocked by the opponent
+				const int jump = moveTables.jump[square][direction];
+				if (jump >= 0 && !(occupied & squareMask(jump))) // if the one after it is on the board and not occupied
+					appendJumps(moves, square, jump, first, last, ~occupied | squareMask(square), opponent, king ? 0 : kingsRow, squareMask(next), 1);
+			}
+		}
+	}
+}
+
+/**
+ * Checks if a side has any move, without generating the moves.
+ * @param position - The current position.
+ * @param turn - The side to check (PLAYER or COMPUTER).
+ * @return true as soon as one stone of the side can step or jump.
+ */
+static bool canMove(const S_Position &position, int turn) {
+	const Bitboard own = turn == COMPUTER ? position.black : position.white;
+	const Bitboard occupied = position.black | position.white;
+	const Bitboard opponent = occupied & ~own;
+	const int manFirst = turn == COMPUTER ? 0 : 2;
+
+	for (Bitboard pieces = own; pieces; pieces &= pieces - 1) {
+		const int square = lowestSquare(pieces);
+		const bool king = (position.kings & squareMask(square)) != 0;
+		const int last = king ? 4 : manFirst + 2;
+		for (int direction = king ? 0 : manFirst; direction < last; direction++) {
+			const int next = moveTables.neighbour[square][direction];
+			if (next < 0)
+				continue;
+			if (!(occupied & squareMask(next)))
+				return true; // a step
+			const int jump = moveTables.jump[square][direction];
+			if ((opponent & squareMask(next)) && jump >= 0 && !(occupied & squareMask(jump)))
+				return true; // a jump
+		}
+	}
+	return false;
+}
+
+/**
+ * Tells if the game is over: a side that can not move has lost, whoever is to move.
+ * @param position - The current position.
+ * @return PLAYER or COMPUTER for the side without a move, PLAYER first when both have none, EMPTY otherwise.
+ */
+E_MoveTurn sideWithoutMoves(const S_Position &position) {
+	if (!canMove(position, PLAYER))
+		return PLAYER;
+	if (!canMove(position, COMPUTER))
+		return COMPUTER;
+	return EMPTY;
+}
+
+/**
+ * Filters a list of moves in place to include only attack moves.
+ * @param moves - The list of moves to filter, keeps the order of the attack moves.
+ */
+void filterAttackMoves(S_MoveList &moves) {
+	int count = 0;
+	for (int i = 0; i < moves.count; i++)
+		if (moves.moves[i].attack)
+			moves.moves[count++] = moves.moves[i];
+	moves.count = count;
+}
+
+/**
+ * Checks if there are any attack moves in a list of moves.
+ * @param moves - The list of moves to check.
+ * @return 1 if there are attack moves, 0 otherwise.
+ */
+int isThereAttackMoves(const S_MoveList &moves) {
+	for (int i = 0; i < moves.count; i++)
+		if (moves.moves[i].attack)
+			return 1;
+	return 0;
+}
+
+/**
+ * Finds the order of the jumps of a capture, the move only holds its ends and the set of jumped squares.
+ * @param position - The position before the move.
+ * @param move - A legal move of the side to move.
+ * @param path - Receives the square the stone lands on after every jump, at least MAX_JUMPS squares, path[attack - 1] is move.to.
+ * @return The number of jumps, 1 for a simple move (path[0] is move.to).
+ */
+int movePath(const S_Position &position, const S_Move &move, unsigned char *path) {
+	if (!move.attack) {
+		path[0] = move.to;
+		return 1;
+	}
+	const Bitboard empty = ~(position.black | position.white) | squareMask(move.from);
+	// depth first over the jumps that stay inside the captured squares, stack[i] is the next direction to try after jump i
+	int stack[MAX_JUMPS + 1] = { 0 };
+	int square = move.from, jumps = 0;
+	Bitboard left = move.captured;
+	while (true) {
+		if (!left && square == move.to)
+			return jumps;
+		int direction = stack[jumps];
+		for (; direction < 4; direction++) {
+			const int jump = moveTables.jump[square][direction];
+			if (jump >= 0 && (empty & squareMask(jump)) && (left & squareMask(moveTables.neighbour[square][direction])))
+				break;
+		}
+		if (direction < 4 && jumps < move.attack) { // jump on
+			stack[jumps] = direction + 1;
+			left &= ~squareMask(moveTables.neighbour[square][direction]);
+			square = moveTables.jump[square][direction];
+			path[jumps++] = (unsigned char)square;
+			stack[jumps] = 0;
+		} else if (jumps > 0) { // back off the last jump
+			jumps--;
+			const int previous = jumps > 0 ? path[jumps - 1] : move.from;
+			left |= squareMask(moveTables.neighbour[previous][stack[jumps] - 1]);
+			square = previous;
+		} else {
+			return 0; // not a legal capture of the position
+		}
+	}
+}
+
+/**
+ * Writes a move as text for game records: the squares numbered from 1 to 32 (square + 1),
+ * "22-18" for a simple move, "15x22x29" for a capture with the square of every landing.
+ * @param position - The position before the move.
+ * @param move - A legal move of the side to move.
+ * @param text - Receives the text, at least MOVE_TEXT_SIZE chars.
+ * @return The length of the text.
+ */
+int moveToText(const S_Position &position, const S_Move &move, char *text) {
+	unsigned char path[MAX_JUMPS];
+	const int jumps = movePath(position, move, path);
+	int length = 0;
+	for (int i = -1; i < jumps; i++) {
+		const int number = (i < 0 ? move.from : path[i]) + 1;
+		if (i >= 0)
+			text[length++] = move.attack ? 'x' : '-';
+		if (number >= 10)
+			text[length++] = (char)('0' + number / 10);
+		text[length++] = (char)('0' + number % 10);
+	}
+	text[length] = '\0';
+	return length;
+}
+
+/**
+ * Reads a move written by moveToText. The squares of the landings of a capture may be left out,
+ * the first capture between the two squares is then taken.
+ * @param position - The position the move is played in.
+ * @param text - The text, ends at the first char that is not part of the move.
+ * @param move - Receives the move.
+ * @return The number of chars read, 0 when the text is not a legal move of the position.
+ */
+int moveFromText(const S_Position &position, const char *text, S_Move &move) {
+	int squares[MAX_JUMPS + 1];
+	int count = 0, length = 0;
+	bool capture = false;
+	while (count <= MAX_JUMPS) {
+		int number = 0, digits = 0;
+		for (; text[length] >= '0' && text[length] <= '9' && digits < 2; digits++)
+			number = number * 10 + text[length++] - '0';
+		if (digits == 0 || number < 1 || number > PLAYABLE_CELLS)
+			return 0;
+		squares[count++] = number - 1;
+		if (text[length] != '-' && text[length] != 'x')
+			break;
+		capture = text[length++] == 'x';
+	}
+	if (count < 2)
+		return 0;
+
+	S_MoveList moves;
+	generateMoves(position, position.turn, moves);
+	if (isThereAttackMoves(moves))
+		filterAttackMoves(moves);
+	for (int i = 0; i < moves.count; i++) {
+		const S_Move &candidate = moves.moves[i];
+		if (candidate.from != squares[0] || candidate.to != squares[count - 1] || (candidate.attack != 0) != capture)
+			continue;
+		if (count > 2) {
+			unsigned char path[MAX_JUMPS];
+			if (movePath(position, candidate, path) != count - 1)
+				continue;
+			int same = 0;
+			while (same < count - 1 && path[same] == squares[same + 1])
+				same++;
+			if (same < count - 1)
+				continue;
+		}
+		move = candidate;
+		return length;
+	}
+	return 0;
+}
+
+/**
+ * Applies a move to the position in place.
+ * @param position - The current position, changed to the position after the move.
+ * @param move - The move to apply, must be a legal move of the side to move.
+ * @param undo - Receives what is needed to take the move back with undoMove.
+ */
+void applyMove(S_Position &position, const S_Move &move, S_Undo &undo) {
+	const Bitboard from = squareMask(move.from);
+	const Bitboard to = squareMask(move.to);
+	const bool black = (position.black & from) != 0;
+	const int kind = (black ? BLACK_MAN : WHITE_MAN) + ((position.kings & from) ? 1 : 0);
+
+	undo.moved = from ^ to;
+	undo.captured = move.captured;
+	undo.kings = position.kings;
+	undo.hash = position.hash;
+	undo.score = position.score;
+
+	// Move the stone to the new position
+	if (black)
+		position.black ^= undo.moved;
+	else
+		position.white ^= undo.moved;
+	if (position.kings & from)
+		position.kings ^= undo.moved;
+
+	// Handle promotion to king
+	if (to & (black ? BLACK_KINGS_ROW : WHITE_KINGS_ROW))
+		position.kings |= to;
+	const int toKind = (kind & ~1) + ((position.kings & to) ? 1 : 0);
+	position.hash ^= zobrist.stone[kind][move.from] ^ zobrist.stone[toKind][move.to];
+	position.score += stoneValues.value[toKind][move.to] - stoneValues.value[kind][move.from];
+
+	// Handle attack moves
+	for (Bitboard captured = move.captured; captured; captured &= captured - 1) {
+		const int square = lowestSquare(captured);
+		const int capturedKind = (black ? WHITE_MAN : BLACK_MAN) + ((position.kings & squareMask(square)) ? 1 : 0);
+		position.hash ^= zobrist.stone[capturedKind][square];
+		position.score -= stoneValues.value[capturedKind][square];
+	}
+	position.black &= ~undo.captured;
+	position.white &= ~undo.captured;
+	position.kings &= ~undo.captured;
+
+	position.turn = black ? PLAYER : COMPUTER;
+	position.hash ^= zobrist.turnKey;
+}
+
+/**
+ * Takes back the last move applied with applyMove.
+ * @param position - The position after the move, restored to the position before it.
+ * @param undo - The record filled in by applyMove.
+ */
+void undoMove(S_Position &position, const S_Undo &undo) {
+	if (position.turn == PLAYER) { // COMPUTER made the move
+		position.black ^= undo.moved;
+		position.white |= undo.captured;
+		position.turn = COMPUTER;
+	} else {
+		position.white ^= undo.moved;
+		position.black |= undo.captured;
+		position.turn = PLAYER;
+	}
+	position.kings = undo.kings;
+	position.hash = undo.hash;
+	position.score = undo.score;
+}
+
+/**
+ * Gives the turn to the other side without moving a stone, used by the null move pruning of the search.
+ * Not a legal move of the game. Calling it a second time gives the position back.
+ * @param position - The position, its turn and hash are changed.
+ */
+void passTurn(S_Position &position) {
+	position.turn = position.turn == COMPUTER ? PLAYER : COMPUTER;
+	position.hash ^= zobrist.turnKey;
+}
+
+/**
+ * Returns the evaluation of one stone, the table scorePosition sums.
+ * @param turn - The side of the stone, PLAYER or COMPUTER.
+ * @param king - Whether the stone is crowned.
+ * @param square - Its square.
+ * @return The value from the COMPUTER's point of view, negative for PLAYER stones.
+ */
+int stoneValue(int turn, bool king, int square) {
+	return stoneValues.value[(turn == COMPUTER ? BLACK_MAN : WHITE_MAN) + (king ? 1 : 0)][square];
+}
+
+/**
+ * Evaluates the position from scratch, from the COMPUTER's point of view.
+ * Stones are counted first: a man is worth MAN_VALUE and a king KING_VALUE,
+ * men are worth a little more the further they advanced.
+ * evaluateBoard returns the score applyMove keeps up to date instead, this is the reference it is checked against.
+ * @param position - The position to evaluate, its score member is ignored.
+ * @return The evaluation score, positive when the COMPUTER is ahead.
+ */
+int scorePosition(const S_Position &position) {
+	int score = 0;
+	for (Bitboard pieces = position.white | position.black; pieces; pieces &= pieces - 1) {
+		const int square = lowestSquare(pieces);
+		const int kind = ((position.black & squareMask(square)) ? BLACK_MAN : WHITE_MAN) + ((position.kings & squareMask(square)) ? 1 : 0);
+		score += stoneValues.value[kind][square];
+	}
+	return score;
+}
@@ -0,0 +1,123 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Position.h                                                               */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Bitboard position of the checkers board                                  */
+/*   used by the computer's search instead of the Checkers class              */
+/* ========================================================================== */
+#pragma once
+#include <assert.h> // evaluateBoard checks the incremental score in debug builds
+#if defined(_MSC_VER)
+#include <intrin.h> // for _BitScanForward and __popcnt
+#endif
+
+typedef enum
+{
+    EMPTY = -1, // used when checkers class is created, and no changes yet occured
+    PLAYER = 0,
+    COMPUTER = 1
+} E_MoveTurn; /* tells who can make action in the game, when game is started */
+
+
+/*
+ * Only the 32 dark blocks of the board can hold a stone,
+ * so a whole side fits in one 32 bit mask.
+ * square = row * 4 + col / 2, the dark blocks are the ones where (row + col) is even
+ */
+typedef unsigned int Bitboard;
+
+#define BOARD_ROWS 8 /* rows and columns of the board */
+#define PLAYABLE_CELLS 32 /* number of dark blocks a stone can stand on */
+#define WHITE_KINGS_ROW 0x0000000Fu /* row 0, where PLAYER men are crowned */
+#define BLACK_KINGS_ROW 0xF0000000u /* row 7, where COMPUTER men are crowned */
+#define MAN_VALUE 100 /* evaluation of a man, plus one for every row it advanced */
+#define KING_VALUE 150 /* evaluation of a king */
+
+struct S_Position /* compact board used by the search, synced with the Checkers class at move boundaries */
+{
+	Bitboard white; // PLAYER stones (men and kings)
+	Bitboard black; // COMPUTER stones (men and kings)
+	Bitboard kings; // stones of both sides that are crowned
+	E_MoveTurn turn; // side to move
+	unsigned long long hash; // Zobrist key of the stones and the side to move, kept up to date by applyMove
+	int score; // evaluation from the COMPUTER's point of view, kept up to date by applyMove
+};
+
+inline int squareIndex(int row, int col) { return row * 4 + col / 2; } /* block (row, col) to square, block must be dark */
+inline int squareRow(int square) { return square / 4; } /* square to block row */
+inline int squareCol(int square) { return (square % 4) * 2 + (square / 4) % 2; } /* square to block col */
+inline Bitboard squareMask(int square) { return (Bitboard)1 << square; }
+
+inline int lowestSquare(Bitboard bb) /* index of the lowest set square, bb must not be empty */
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, bb);
+	return (int)index;
+#else
+	return __builtin_ctz(bb);
+#endif
+}
+
+inline int countSquares(Bitboard bb) /* number of set squares */
+{
+#if defined(_MSC_VER)
+	return (int)__popcnt(bb);
+#else
+	return __builtin_popcount(bb);
+#endif
+}
+
+struct S_Move /* whole turn of one stone packed in 8 bytes, used for calculating steps while the game is running */
+{
+	unsigned char from; // square the stone leaves
+	unsigned char to; // square the stone ends the turn on, after the last jump of a capture
+	unsigned char attack; // number of opponent stones jumped, 0 for a simple move
+	Bitboard captured; // squares of all the jumped stones, 0 for a simple move
+};
+
+inline bool isEmptyMove(const S_Move &move) { return move.from == move.to && !move.attack; } /* S_Move() is no move, a king's capture may end where it started */
+inline bool sameMove(const S_Move &a, const S_Move &b) { return a.from == b.from && a.to == b.to && a.captured == b.captured; }
+
+#define MAX_MOVES 128 /* room for the steps (12 stones, at most 4 each) and the captures generated with them before they are filtered */
+#define MAX_JUMPS 12 /* a capture can not jump more stones than the opponent has */
+#define MOVE_TEXT_SIZE 40 /* longest text of a move, see moveToText: 13 squares, the separators and the end */
+
+struct S_MoveList /* fixed capacity list of moves, lives on the stack, nothing is allocated */
+{
+	S_Move moves[MAX_MOVES];
+	int count;
+};
+
+struct S_Undo /* what applyMove changed, so undoMove can put the position back */
+{
+	Bitboard moved; // from and to squares of the moving stone, 0 when a capture ends where it started
+	Bitboard captured; // squares of the captured stones, 0 when nothing was captured
+	Bitboard kings; // kings of both sides before the move (promotion and captured kings)
+	unsigned long long hash; // Zobrist key before the move
+	int score; // evaluation before the move
+};
+
+S_Position initialPosition(); // the position of a new game, PLAYER to move
+unsigned long long hashPosition(const S_Position &position); // Zobrist key computed from scratch
+int scorePosition(const S_Position &position); // evaluation computed from scratch
+int stoneValue(int turn, bool king, int square); // evaluation of one stone, scorePosition sums them
+
+void generateMoves(const S_Position &position, int turn, S_MoveList &moves);
+void filterAttackMoves(S_MoveList &moves);
+int isThereAttackMoves(const S_MoveList &moves);
+int movePath(const S_Position &position, const S_Move &move, unsigned char *path); // landing squares of every jump, for showing a capture hop by hop
+int moveToText(const S_Position &position, const S_Move &move, char *text); // "22-18" or "15x22x29", for game records
+int moveFromText(const S_Position &position, const char *text, S_Move &move); // chars read, 0 when not a legal move
+E_MoveTurn sideWithoutMoves(const S_Position &position); // the side that lost for having no move, EMPTY while both sides can move
+
+void applyMove(S_Position &position, const S_Move &move, S_Undo &undo);
+void undoMove(S_Position &position, const S_Undo &undo);
+void passTurn(S_Position &position); // null move: the other side moves next, calling it again takes it back
+
+inline int evaluateBoard(const S_Position &position) /* evaluation from the COMPUTER's point of view, positive when the COMPUTER is ahead */
+{
+	assert(position.score == scorePosition(position)); // debug builds check applyMove against the full recompute at every leaf
+	return position.score;
+}
@@ -0,0 +1,702 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Search.cpp                                                               */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   MiniMax and alpha-beta search implementation                             */
+/*   used by the computer player                                              */
+/* ========================================================================== */
+
+#include "Search.h"
+#include <climits> // for INT_MAX
+#include <string.h> // for memcmp in the debug check of the accumulators
+#include <thread>
+#include <vector>
+
+
+/**
+ * MiniMax algorithm implementation.
+ * @param position - The current position, moves are applied and taken back in place.
+ * @param depth - The depth to which the algorithm should explore.
+ * @param turn - The current player's turn (COMPUTER is the maximizing player, PLAYER is the minimizing player).
+ * @param stats - Optional counters, nodes is incremented for every position visited.
+ * @return The evaluation score of the board.
+ */
+int miniMax(S_Position &position, int depth, int turn, S_SearchStats *stats) {
+	if (stats)
+		stats->nodes++;
+
+	// Base case: if we've reached the maximum depth, evaluate the board
+	if (depth == 0)
+		return evaluateBoard(position);
+
+	// COMPUTER maximizes, PLAYER minimizes. A side without moves keeps the worst value
+	int bestValue = turn == COMPUTER ? -INT_MAX : INT_MAX;
+	S_MoveList moves;
+	generateMoves(position, turn, moves); // Generate all possible moves
+	if (isThereAttackMoves(moves)) // Filter attack moves if available
+		filterAttackMoves(moves);
+
+	// Iterate through all possible moves
+	for (int i = 0; i < moves.count; i++) {
+		S_Undo undo;
+		applyMove(position, moves.moves[i], undo); // Apply the move in place
+		int value = miniMax(position, depth - 1, turn == COMPUTER ? PLAYER : COMPUTER, stats); // Recursively call miniMax for the opponent
+		undoMove(position, undo); // and take it back
+		if (turn == COMPUTER ? value > bestValue : value < bestValue)
+			bestValue = value;
+	}
+	return bestValue; // Return the best value found
+}
+
+/**
+ * Stores a new best line at ply: the move followed by the best line found from ply + 1.
+ * @param context - The search state holding the triangular PV table.
+ * @param ply - Distance from the root.
+ * @param move - The move that became the best move at ply.
+ */
+static void updatePV(S_SearchContext &context, int ply, const S_Move &move) {
+	context.pv[ply][0] = move;
+	const int childLength = ply + 1 < MAX_PLY ? context.pvLength[ply + 1] : 0;
+	for (int i = 0; i < childLength; i++)
+		context.pv[ply][i + 1] = context.pv[ply + 1][i];
+	context.pvLength[ply] = childLength + 1;
+}
+
+/**
+ * Scores the moves of a node for move ordering, higher is searched first:
+ * the transposition table's best move (the best move of the previous iteration), then the two killer moves of the ply,
+ * then the other moves by their history score.
+ * @param moves - The list of legal moves.
+ * @param scores - Receives the score of every move.
+ * @param ttEntry - The transposition table entry of the position, NULL when there is none. Its move is ignored when it is not in the list (a key collision).
+ * @param ply - Distance from the root, selects the killer moves.
+ * @param context - The search state holding the killer moves and the history table.
+ */
+static void scoreMoves(const S_MoveList &moves, int *scores, const S_TTData *ttEntry, int ply, const S_SearchContext &context) {
+	if (ttEntry && !ttHasMove(*ttEntry))
+		ttEntry = NULL;
+	const S_Move &killer0 = context.killers[ply][0];
+	const S_Move &killer1 = context.killers[ply][1];
+	for (int i = 0; i < moves.count; i++) {
+		const S_Move &move = moves.moves[i];
+		if (ttEntry && ttIsMove(*ttEntry, move))
+			scores[i] = 1 << 30;
+		else if (move.from == killer0.from && move.to == killer0.to)
+			scores[i] = (1 << 29) + 1;
+		else if (move.from == killer1.from && move.to == killer1.to)
+			scores[i] = 1 << 29;
+		else
+			scores[i] = context.history[move.from][move.to];
+	}
+}
+
+/**
+ * Brings the best scored move among the moves not searched yet to position i.
+ * Selecting one move at a time is cheaper than sorting, most nodes cut off after the first few moves.
+ * @param moves - The list of legal moves, moves before i are searched already.
+ * @param scores - The scores of the moves, kept in the same order.
+ * @param i - The position to fill.
+ */
+static void pickMove(S_MoveList &moves, int *scores, int i) {
+	int best = i;
+	for (int j = i + 1; j < moves.count; j++)
+		if (scores[j] > scores[best])
+			best = j;
+	if (best != i) {
+		const S_Move move = moves.moves[i];
+		moves.moves[i] = moves.moves[best];
+		moves.moves[best] = move;
+		const int score = scores[i];
+		scores[i] = scores[best];
+		scores[best] = score;
+	}
+}
+
+/**
+ * Remembers a move that made a node cut off: as a killer move of the ply and in the history table.
+ * Captures are not remembered, they are forced and searched anyway.
+ * @param context - The search state holding the killer moves and the history table.
+ * @param move - The move that cut off.
+ * @param depth - Remaining depth of the node, deeper cutoffs count more in the history table.
+ * @param ply - Distance from the root.
+ */
+static void rememberCutoff(S_SearchContext &context, const S_Move &move, int depth, int ply) {
+	if (move.attack)
+		return;
+	S_Move *killers = context.killers[ply];
+	if (killers[0].from != move.from || killers[0].to != move.to) {
+		killers[1] = killers[0];
+		killers[0] = move;
+	}
+	int &history = context.history[move.from][move.to];
+	history += depth * depth;
+	if (history > HISTORY_MAX) // keep the scores under the killers, the proportions are what counts
+		for (int from = 0; from < PLAYABLE_CELLS; from++)
+			for (int to = 0; to < PLAYABLE_CELLS; to++)
+				context.history[from][to] /= 2;
+}
+
+/**
+ * Looks at the clock and the cancel flag every 1024 nodes, once stopped every node returns right away.
+ * @param context - The search state, stopped is set when the deadline passed or the search was cancelled.
+ * @return true when the search must stop.
+ */
+static inline bool checkStop(S_SearchContext &context) {
+	if ((context.stats.nodes & 1023) == 0) {
+		if ((context.timed && std::chrono::steady_clock::now() >= context.deadline) || (context.cancel && context.cancel->load(std::memory_order_relaxed)))
+			context.stopped = true;
+	}
+	return context.stopped;
+}
+
+/**
+ * Looks the position up in the endgame tablebase, when there is one and the position has few enough stones.
+ * A win scores SCORE_TB_WIN less the plies it takes, so the search prefers the shortest win and the longest loss.
+ * @param position - The position.
+ * @param context - The search state, stats.tbHits is incremented when the position is found.
+ * @param value - Receives the exact score from the side to move's point of view.
+ * @return true when the position was found.
+ */
+static bool probeTablebase(const S_Position &position, S_SearchContext &context, int &value) {
+	if (!context.tablebase || countSquares(position.white | position.black) > context.tablebase->maxPieces)
+		return false;
+	int distance;
+	const E_TbResult result = tbProbe(*context.tablebase, position, distance);
+	if (result == TB_MISSING)
+		return false;
+	context.stats.tbHits++;
+	value = result == TB_WIN ? SCORE_TB_WIN - distance : result == TB_LOSS ? distance - SCORE_TB_WIN : 0;
+	return true;
+}
+
+/**
+ * Makes a win found by the search count its plies from the position instead of the root, to store it in the transposition table:
+ * the same position may be probed at another ply. Tablebase scores already count from the position.
+ * @param score - The score of the position at ply.
+ * @param ply - Distance of the position from the root.
+ * @return The score to store.
+ */
+static inline int scoreToTable(int score, int ply) {
+	return score >= SCORE_WIN_MIN ? score + ply : score <= -SCORE_WIN_MIN ? score - ply : score;
+}
+
+/**
+ * Inverse of scoreToTable, for a score read from the transposition table.
+ * @param score - The stored score.
+ * @param ply - Distance of the probed position from the root.
+ * @return The score of the position at ply.
+ */
+static inline int scoreFromTable(int score, int ply) {
+	return score >= SCORE_WIN_MIN ? score - ply : score <= -SCORE_WIN_MIN ? score + ply : score;
+}
+
+/**
+ * Applies a move in place for the search. With a network, the accumulator of the next ply is computed from this ply's first.
+ * @param position - The position at ply, becomes the position after the move.
+ * @param move - A legal move of the position.
+ * @param undo - Receives what undoMove needs, the accumulator of ply is left as it was.
+ * @param ply - Distance of the position from the root, below MAX_PLY - 1.
+ * @param context - The search state.
+ */
+static inline void searchApplyMove(S_Position &position, const S_Move &move, S_Undo &undo, int ply, S_SearchContext &context) {
+	if (context.network)
+		nnUpdate(*context.network, position, move, context.accumulators[ply], context.accumulators[ply + 1]);
+	applyMove(position, move, undo);
+}
+
+/**
+ * Evaluates a position of the search, with the network when the search has one, else with evaluateBoard.
+ * @param position - The position at ply.
+ * @param ply - Distance from the root, selects the accumulator.
+ * @param context - The search state.
+ * @return The evaluation from the side to move's point of view.
+ */
+static inline int searchEvaluate(const S_Position &position, int ply, const S_SearchContext &context) {
+#if !defined(NDEBUG)
+	if (context.network) { // debug builds check nnUpdate against the full recompute, as evaluateBoard checks applyMove
+		S_Accumulator fresh;
+		nnRefresh(*context.network, position, fresh);
+		assert(memcmp(&fresh, &context.accumulators[ply], sizeof(fresh)) == 0);
+	}
+#endif
+	const int score = context.network ? nnEvaluate(*context.network, context.accumulators[ply], position.turn) : evaluateBoard(position);
+	return position.turn == COMPUTER ? score : -score;
+}
+
+/**
+ * Quiescence search: at the leaves of the alpha-beta search, plays out the pending captures before evaluating.
+ * Captures are mandatory, so while the side to move has one there is no standing pat: all its captures are searched.
+ * A position without captures is quiet and is evaluated. This keeps a leaf from being scored in the middle of an exchange.
+ * @param position - The current position, position.turn is the side to move. Moves are applied and taken back in place.
+ * @param ply - Distance from the root.
+ * @param alpha - Lower bound, the side to move already has a line worth alpha.
+ * @param beta - Upper bound, the opponent already has a line that holds the score below beta.
+ * @param context - The search state, stats.nodes and stats.qNodes are incremented for every position visited.
+ * @return The score of the position from the side to move's point of view.
+ */
+static int quiescence(S_Position &position, int ply, int alpha, int beta, S_SearchContext &context) {
+	context.stats.nodes++;
+	context.stats.qNodes++;
+	context.pvLength[ply] = 0;
+	if (checkStop(context))
+		return 0;
+
+	S_MoveList moves;
+	generateMoves(position, position.turn, moves);
+	if (moves.count == 0)
+		return ply - SCORE_WIN; // a side without moves has lost, the nearer the loss the lower
+	if (!isThereAttackMoves(moves) || ply >= MAX_PLY - 1) { // quiet
+		int value;
+		if (probeTablebase(position, context, value))
+			return value;
+		return searchEvaluate(position, ply, context);
+	}
+	filterAttackMoves(moves);
+
+	int bestValue = -SCORE_INFINITE;
+	for (int i = 0; i < moves.count; i++) {
+		S_Undo undo;
+		searchApplyMove(position, moves.moves[i], undo, ply, context);
+		const int value = -quiescence(position, ply + 1, -beta, -alpha, context);
+		undoMove(position, undo);
+		if (context.stopped)
+			return 0;
+		if (value > bestValue) {
+			bestValue = value;
+			if (value > alpha)
+				alpha = value;
+			if (alpha >= beta)
+				break;
+		}
+	}
+	return bestValue;
+}
+
+/**
+ * Late move reductions: how much shallower a move is searched first.
+ * Moves after the first LMR_FULL_MOVES (the table move and the killers come first) are rarely the best,
+ * so quiet ones lose a ply, and two plies late in the list of a deep node. Captures are never reduced.
+ * @param move - The move about to be searched.
+ * @param index - Its place in the order the moves are searched.
+ * @param depth - Remaining depth of the node.
+ * @param context - The search state, holds the options and counts the reductions.
+ * @return The reduction in plies, 0 for a full depth search.
+ */
+static int lateMoveReduction(const S_Move &move, int index, int depth, S_SearchContext &context) {
+	if (!context.options.lateMoveReductions || move.attack || index < LMR_FULL_MOVES || depth < LMR_MIN_DEPTH)
+		return 0;
+	context.stats.lmrReductions++;
+	return index >= 2 * LMR_FULL_MOVES && depth >= 2 * LMR_MIN_DEPTH ? 2 : 1;
+}
+
+/**
+ * Verified null move pruning: if the side to move stays above beta even after passing its turn,
+ * a real move will most likely too. Checkers has many zugzwang positions where passing would be
+ * the best move, so a fail high is only trusted after a normal search, reduced by NULL_MOVE_R, confirms it.
+ * Not used with a capture pending (it is forced), with few stones, or right after another null move.
+ * @param position - The current position, the null move is made and taken back in place.
+ * @param depth - Remaining depth of the node.
+ * @param ply - Distance from the root.
+ * @param beta - The zero window bound of the node.
+ * @param captures - Whether the side to move has a capture.
+ * @param context - The search state.
+ * @param value - Receives the score to return when the node is pruned.
+ * @return true when the node is pruned.
+ */
+static bool nullMovePrune(S_Position &position, int depth, int ply, int beta, bool captures, S_SearchContext &context, int &value) {
+	if (!context.options.nullMove || captures || depth <= NULL_MOVE_R || context.afterNull[ply] || context.verifying)
+		return false;
+	if (countSquares(position.turn == COMPUTER ? position.black : position.white) < NULL_MOVE_MIN_STONES)
+		return false;
+	const int eval = searchEvaluate(position, ply, context);
+	if (eval < beta)
+		return false;
+
+	if (context.network)
+		context.accumulators[ply + 1] = context.accumulators[ply]; // passing moves no stone
+	passTurn(position);
+	context.afterNull[ply + 1] = true;
+	value = -alphaBeta(position, depth - 1 - NULL_MOVE_R, ply + 1, -beta, -beta + 1, context);
+	passTurn(position);
+	if (context.stopped || value < beta)
+		return false;
+
+	// Verify with a real search, it would fail low in zugzwang
+	context.verifying++;
+	value = alphaBeta(position, depth - NULL_MOVE_R, ply, beta - 1, beta, context);
+	context.verifying--;
+	if (context.stopped || value < beta)
+		return false;
+	context.stats.nullCutoffs++;
+	return true;
+}
+
+/**
+ * ProbCut: a search PROBCUT_REDUCTION plies shallower is a good predictor of the deep one,
+ * so when it beats beta by PROBCUT_MARGIN the deep search would almost surely fail high too.
+ * @param position - The current position.
+ * @param depth - Remaining depth of the node.
+ * @param ply - Distance from the root.
+ * @param beta - The zero window bound of the node.
+ * @param context - The search state.
+ * @param value - Receives the score to return when the node is pruned.
+ * @return true when the node is pruned.
+ */
+static bool probCutPrune(S_Position &position, int depth, int ply, int beta, S_SearchContext &context, int &value) {
+	if (!context.options.probCut || depth < PROBCUT_MIN_DEPTH)
+		return false;
+	const int probBeta = beta + PROBCUT_MARGIN;
+	if (probBeta >= SCORE_WIN_MIN)
+		return false;
+	value = alphaBeta(position, depth - PROBCUT_REDUCTION, ply, probBeta - 1, probBeta, context);
+	if (context.stopped || value < probBeta)
+		return false;
+	context.stats.probCuts++;
+	return true;
+}
+
+/**
+ * Alpha-beta search with principal variation search (negamax form).
+ * The first move of every node is searched with the full window, the other moves
+ * with a zero window around alpha, and are searched again only when they beat alpha.
+ * Positions already searched deep enough are answered from the transposition table.
+ * Moves are searched in the order of scoreMoves, the leaves are searched by quiescence.
+ * @param position - The current position, position.turn is the side to move. Moves are applied and taken back in place.
+ * @param depth - The depth to which the algorithm should explore.
+ * @param ply - Distance from the root, used to index the PV table.
+ * @param alpha - Lower bound, the side to move already has a line worth alpha.
+ * @param beta - Upper bound, the opponent already has a line that holds the score below beta.
+ * @param context - The search state, stats.nodes is incremented for every position visited.
+ * @return The score of the position from the side to move's point of view, not valid once context.stopped is set.
+ */
+int alphaBeta(S_Position &position, int depth, int ply, int alpha, int beta, S_SearchContext &context) {
+	// Base case: if we've reached the maximum depth, evaluate the board once the captures are played out
+	if (depth == 0)
+		return quiescence(position, ply, alpha, beta, context);
+
+	context.stats.nodes++;
+	context.pvLength[ply] = 0;
+	if (checkStop(context))
+		return 0;
+	if (ply >= MAX_PLY - 1)
+		return searchEvaluate(position, ply, context);
+
+	// The tablebase knows the exact result, there is nothing to search (never at the root, it needs a move)
+	int tablebaseValue;
+	if (ply > 0 && probeTablebase(position, context, tablebaseValue))
+		return tablebaseValue;
+
+	// Look the position up, a deep enough result ends the search of this node (never at the root, it needs a move)
+	S_TTData entry;
+	bool found = false;
+	if (context.table) {
+		context.stats.ttProbes++;
+		found = ttProbe(*context.table, position.hash, entry);
+		if (found) {
+			context.stats.ttHits++;
+			if (ply > 0 && entry.depth >= depth) {
+				const E_Bound bound = ttBound(entry);
+				const int score = scoreFromTable(entry.score, ply);
+				if (bound == BOUND_EXACT || (bound == BOUND_LOWER && score >= beta) || (bound == BOUND_UPPER && score <= alpha)) {
+					context.stats.ttCutoffs++;
+					return score;
+				}
+			}
+		}
+	}
+
+	S_MoveList moves;
+	generateMoves(position, position.turn, moves); // Generate all possible moves
+	const bool captures = isThereAttackMoves(moves) != 0;
+	if (captures) // Filter attack moves if available
+		filterAttackMoves(moves);
+	if (moves.count == 0)
+		return ply - SCORE_WIN; // a side without moves has lost, the nearer the loss the lower
+
+	// Pruning, only in zero window nodes: a PV node needs its exact score
+	const bool pvNode = beta - alpha > 1;
+	if (!pvNode && ply > 0 && beta > -SCORE_WIN_MIN && beta < SCORE_WIN_MIN) {
+		int value;
+		if (nullMovePrune(position, depth, ply, beta, captures, context, value))
+			return value;
+		if (probCutPrune(position, depth, ply, beta, context, value))
+			return value;
+	}
+
+	int scores[MAX_MOVES];
+	scoreMoves(moves, scores, found ? &entry : NULL, ply, context);
+
+	const int alphaOrig = alpha;
+	int bestValue = -SCORE_INFINITE;
+	S_Move bestMove = S_Move(); // no move, see isEmptyMove
+	for (int i = 0; i < moves.count; i++) {
+		pickMove(moves, scores, i);
+		S_Undo undo;
+		searchApplyMove(position, moves.moves[i], undo, ply, context); // Apply the move in place
+		context.afterNull[ply + 1] = false;
+		int value;
+		if (i == 0) {
+			value = -alphaBeta(position, depth - 1, ply + 1, -beta, -alpha, context); // principal variation, full window
+		} else {
+			// Late quiet moves are searched shallower first, at full depth only if they beat alpha
+			const int reduction = lateMoveReduction(moves.moves[i], i, depth, context);
+			value = -alphaBeta(position, depth - 1 - reduction, ply + 1, -alpha - 1, -alpha, context); // zero window, only tells if it beats alpha
+			if (reduction && value > alpha) {
+				context.stats.lmrResearches++;
+				value = -alphaBeta(position, depth - 1, ply + 1, -alpha - 1, -alpha, context);
+			}
+			if (value > alpha && value < beta)
+				value = -alphaBeta(position, depth - 1, ply + 1, -beta, -alpha, context); // it does, search again for the exact score
+		}
+		undoMove(position, undo); // and take it back
+		if (context.stopped)
+			return 0; // the score of an unfinished search must not reach the PV or the table
+		if (value > bestValue) {
+			bestValue = value;
+			if (value > alpha) {
+				alpha = value;
+				bestMove = moves.moves[i];
+				updatePV(context, ply, moves.moves[i]);
+			}
+			if (alpha >= beta) {
+				context.stats.betaCutoffs++;
+				if (i == 0)
+					context.stats.firstMoveCutoffs++;
+				rememberCutoff(context, moves.moves[i], depth, ply);
+				break; // the opponent will not allow this line
+			}
+		}
+	}
+
+	if (context.table) {
+		const E_Bound bound = bestValue >= beta ? BOUND_LOWER : bestValue > alphaOrig ? BOUND_EXACT : BOUND_UPPER;
+		ttStore(*context.table, position.hash, depth, bound, scoreToTable(bestValue, ply), bestMove);
+	}
+	return bestValue;
+}
+
+/**
+ * Copies the principal variation of the root out of the search state.
+ * @param result - Receives the best move, the score and the principal variation.
+ * @param context - The search state after a completed search.
+ * @param score - The score the search returned.
+ */
+static void takeRootResult(S_SearchResult &result, const S_SearchContext &context, int score) {
+	result.score = score;
+	result.pvLength = context.pvLength[0];
+	for (int i = 0; i < result.pvLength; i++)
+		result.pv[i] = context.pv[0][i];
+	if (result.pvLength)
+		result.move = result.pv[0];
+}
+
+/**
+ * Searches the position and returns the best move, its score and the principal variation in one pass.
+ * @param position - The position to search, position.turn is the side to move.
+ * @param depth - The depth in plies, at least 1.
+ * @param table - Transposition table kept between searches, NULL to search without one.
+ * @param options - Pruning techniques to use.
+ * @return The search result, pvLength is 0 when the side to move has no legal moves.
+ */
+S_SearchResult searchRoot(const S_Position &position, int depth, S_TransTable *table, const S_SearchOptions &options) {
+	S_SearchResult result;
+	S_SearchContext *context = new S_SearchContext(); // too big for the stack of the GUI thread
+	context->options = options;
+	context->table = table;
+	context->tablebase = NULL;
+	context->network = NULL;
+	context->timed = false;
+	context->cancel = NULL;
+	context->stopped = false;
+	if (table)
+		ttNewSearch(*table);
+	S_Position board = position; // the only copy of the board, the search works on it in place
+
+	result.depth = depth < 1 ? 1 : depth;
+	takeRootResult(result, *context, alphaBeta(board, result.depth, 0, -SCORE_INFINITE, SCORE_INFINITE, *context));
+	result.stats = context->stats;
+
+	delete context;
+	return result;
+}
+
+/**
+ * Adds the counters of a helper thread to the result.
+ */
+static void addStats(S_SearchStats &total, const S_SearchStats &stats) {
+	total.nodes += stats.nodes;
+	total.ttProbes += stats.ttProbes;
+	total.ttHits += stats.ttHits;
+	total.ttCutoffs += stats.ttCutoffs;
+	total.betaCutoffs += stats.betaCutoffs;
+	total.firstMoveCutoffs += stats.firstMoveCutoffs;
+	total.qNodes += stats.qNodes;
+	total.lmrReductions += stats.lmrReductions;
+	total.lmrResearches += stats.lmrResearches;
+	total.nullCutoffs += stats.nullCutoffs;
+	total.probCuts += stats.probCuts;
+	total.tbHits += stats.tbHits;
+}
+
+/**
+ * Helper thread of the lazy SMP search: deepens the same position on its own board, only sharing the transposition table.
+ * What it stores there makes the main thread's iterations faster, its own results are thrown away.
+ * Odd helpers start one iteration deeper, so the threads do not all search the same depth at the same time.
+ * @param position - The position to search.
+ * @param helper - Number of the helper, 1 for the first one.
+ * @param table - The shared transposition table.
+ * @param limits - Last iteration, pruning, tablebase and network of the search, the time budget and cancel flag are the main thread's.
+ * @param stop - Set by the main thread when it is done.
+ * @param stats - Receives the counters of the helper.
+ */
+static void helperSearch(S_Position position, int helper, S_TransTable *table, S_SearchLimits limits, const std::atomic<bool> *stop, S_SearchStats *stats) {
+	S_SearchContext *context = new S_SearchContext();
+	context->options = limits.options;
+	context->table = table;
+	context->tablebase = limits.tablebase;
+	context->network = limits.network;
+	if (context->network)
+		nnRefresh(*context->network, position, context->accumulators[0]);
+	context->timed = false;
+	context->cancel = stop;
+	context->stopped = false;
+	for (int depth = 1 + (helper & 1); depth <= limits.depth && !context->stopped; depth++)
+		alphaBeta(position, depth, 0, -SCORE_INFINITE, SCORE_INFINITE, *context);
+	*stats = context->stats;
+	delete context;
+}
+
+/**
+ * Picks the root move from the endgame tablebase: the shortest win, or when every move loses the longest loss.
+ * A drawn position is searched instead, the tablebase keeps that search from any losing move
+ * and the search picks the draw that gives the opponent the most chances to go wrong.
+ * @param position - The root position.
+ * @param moves - Its legal moves.
+ * @param tablebase - The endgame tablebase.
+ * @param result - Receives the move with depth 0 when the function returns true.
+ * @return true when the move was picked, false when a move leads out of the tablebase or the best result is a draw.
+ */
+static bool tablebaseRootMove(const S_Position &position, const S_MoveList &moves, const S_Tablebase &tablebase, S_SearchResult &result) {
+	int best = -1, bestValue = -SCORE_INFINITE;
+	for (int i = 0; i < moves.count; i++) {
+		S_Position next = position;
+		S_Undo undo;
+		applyMove(next, moves.moves[i], undo);
+		int distance;
+		const E_TbResult outcome = tbProbe(tablebase, next, distance);
+		if (outcome == TB_MISSING)
+			return false;
+		const int value = outcome == TB_LOSS ? SCORE_TB_WIN - distance - 1 : outcome == TB_WIN ? distance + 1 - SCORE_TB_WIN : 0;
+		if (value > bestValue) {
+			bestValue = value;
+			best = i;
+		}
+	}
+	if (bestValue == 0)
+		return false;
+	result.move = result.pv[0] = moves.moves[best];
+	result.pvLength = 1;
+	result.score = bestValue;
+	result.stats.tbHits = moves.count;
+	return true;
+}
+
+/**
+ * Iterative deepening: searches the position to depth 1, 2, 3, ... until the time budget runs out or limits.depth is done.
+ * The result is the one of the last iteration that completed, the iteration cut by the deadline is thrown away.
+ * Each iteration leaves its best moves in the transposition table, so the next one searches them first.
+ * A new iteration is not started after half of the budget is used, as it would most likely not complete.
+ * Depth 1 always completes, so there is a move even with a budget of 0.
+ * With more than one thread the search is lazy SMP: helper threads search the same position at the same time,
+ * filling the shared table, and the main thread reports its own result. Without a table the helpers are not started.
+ * With a tablebase, a won or lost root in it is not searched: its best move is read from the tablebase.
+ * With a network, the leaves are evaluated by it instead of evaluateBoard.
+ * @param position - The position to search, position.turn is the side to move.
+ * @param limits - Time budget, last depth, number of threads and cancel flag of the search.
+ *                 A cancelled search returns the last iteration it completed, pvLength is 0 when it completed none.
+ * @param table - Transposition table kept between searches, NULL to search without one.
+ * @return The search result, pvLength is 0 when the side to move has no legal moves.
+ *         When there is a single legal move it is returned right away with depth 0.
+ */
+S_SearchResult iterativeDeepening(const S_Position &position, const S_SearchLimits &limits, S_TransTable *table) {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	S_SearchResult result;
+	result.depth = 0;
+	result.pvLength = 0;
+	result.score = 0;
+
+	// No choice to make, do not spend the budget on it
+	S_MoveList moves;
+	generateMoves(position, position.turn, moves);
+	if (isThereAttackMoves(moves))
+		filterAttackMoves(moves);
+	if (moves.count == 0) {
+		result.score = -SCORE_WIN;
+		return result;
+	}
+	if (moves.count == 1) {
+		result.move = result.pv[0] = moves.moves[0];
+		result.pvLength = 1;
+		int score = evaluateBoard(position);
+		if (limits.network) {
+			S_Accumulator accumulator;
+			nnRefresh(*limits.network, position, accumulator);
+			score = nnEvaluate(*limits.network, accumulator, position.turn);
+		}
+		result.score = position.turn == COMPUTER ? score : -score;
+		return result;
+	}
+	if (limits.tablebase && tablebaseRootMove(position, moves, *limits.tablebase, result))
+		return result;
+
+	S_SearchContext *context = new S_SearchContext(); // too big for the stack of the GUI thread
+	context->options = limits.options;
+	context->table = table;
+	context->tablebase = limits.tablebase;
+	context->network = limits.network;
+	if (context->network)
+		nnRefresh(*context->network, position, context->accumulators[0]);
+	context->timed = false; // not for depth 1
+	context->cancel = limits.cancel;
+	context->stopped = false;
+	context->deadline = start + std::chrono::milliseconds(limits.milliseconds < 0 ? 0 : limits.milliseconds);
+	if (table)
+		ttNewSearch(*table);
+
+	// Lazy SMP helpers
+	const int helpers = table && limits.threads > 1 ? limits.threads - 1 : 0;
+	std::atomic<bool> stopHelpers(false);
+	std::vector<std::thread> threads;
+	std::vector<S_SearchStats> helperStats(helpers);
+	for (int i = 0; i < helpers; i++)
+		threads.push_back(std::thread(helperSearch, position, i + 1, table, limits, &stopHelpers, &helperStats[i]));
+
+	S_Position board = position; // the only copy of the board, the search works on it in place
+	const int maxDepth = limits.depth < MAX_PLY - 2 ? limits.depth : MAX_PLY - 2;
+	for (int depth = 1; depth <= maxDepth; depth++) {
+		const int score = alphaBeta(board, depth, 0, -SCORE_INFINITE, SCORE_INFINITE, *context);
+		if (context->stopped)
+			break; // keep the last completed iteration
+		takeRootResult(result, *context, score);
+		result.depth = depth;
+		if (score >= SCORE_WIN_MIN || score <= -SCORE_WIN_MIN)
+			break; // the game is decided, deeper searches will not change it
+		if (limits.milliseconds >= 0) {
+			const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			if ((now - start) * 2 >= context->deadline - start)
+				break; // the next iteration would not complete
+			context->timed = true;
+		}
+	}
+	result.stats = context->stats;
+
+	stopHelpers = true;
+	for (int i = 0; i < helpers; i++) {
+		threads[i].join();
+		addStats(result.stats, helperStats[i]);
+	}
+
+	delete context;
+	return result;
+}
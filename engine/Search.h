@@ -0,0 +1,104 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Search.h                                                                 */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Game tree search of the computer player                                  */
+/*   running on the bitboard position                                         */
+/* ========================================================================== */
+#pragma once
+#include "Position.h"
+#include "Transposition.h"
+#include "Tablebase.h"
+#include "Network.h"
+#include <stddef.h> // for NULL
+#include <chrono> // for the time budget of iterativeDeepening
+#include <atomic> // for cancelling iterativeDeepening from another thread
+
+#define SCORE_INFINITE 32000 /* bound of every search window */
+#define SCORE_WIN 30000 /* score of a position where the side to move has no moves left, less its ply so nearer wins score higher */
+#define SCORE_WIN_MIN (SCORE_WIN - MAX_PLY) /* lowest score of a win found by the search */
+#define SCORE_TB_WIN (SCORE_WIN - 1000) /* score of a tablebase win, minus the plies it takes */
+#define MAX_PLY 64 /* deepest line the search keeps track of */
+#define HISTORY_MAX (1 << 20) /* history scores are halved when one passes it */
+#define LMR_FULL_MOVES 3 /* moves of a node searched to full depth before late move reductions start */
+#define LMR_MIN_DEPTH 3 /* late move reductions are not used closer to the leaves */
+#define NULL_MOVE_R 2 /* depth reduction of the null move search */
+#define NULL_MOVE_MIN_STONES 5 /* no null move with fewer own stones, zugzwang gets too likely */
+#define PROBCUT_MIN_DEPTH 5 /* ProbCut is not used closer to the leaves */
+#define PROBCUT_REDUCTION 4 /* depth reduction of the ProbCut search */
+#define PROBCUT_MARGIN 60 /* the shallow search must beat beta by that much to cut */
+
+struct S_SearchOptions /* pruning techniques of the search, each can be switched off at runtime to measure it */
+{
+	S_SearchOptions() : lateMoveReductions(true), nullMove(false), probCut(true) {}
+	bool lateMoveReductions; // search late quiet moves shallower first, again at full depth if they beat alpha
+	bool nullMove; // verified null move pruning, off by default: checkers has many zugzwang positions
+	bool probCut; // cut when a shallow search beats beta by PROBCUT_MARGIN
+};
+
+struct S_SearchStats /* counters filled in while searching */
+{
+	S_SearchStats() : nodes(0), ttProbes(0), ttHits(0), ttCutoffs(0), betaCutoffs(0), firstMoveCutoffs(0), qNodes(0),
+		lmrReductions(0), lmrResearches(0), nullCutoffs(0), probCuts(0), tbHits(0) {}
+	unsigned long long nodes; // positions visited, including the root and the leaves
+	unsigned long long ttProbes; // transposition table lookups
+	unsigned long long ttHits; // lookups that found the position
+	unsigned long long ttCutoffs; // hits deep enough to return without searching
+	unsigned long long betaCutoffs; // nodes that stopped searching their moves because one reached beta
+	unsigned long long firstMoveCutoffs; // of those, the ones where it was the first move searched (good move ordering)
+	unsigned long long qNodes; // nodes visited by the quiescence search, included in nodes
+	unsigned long long lmrReductions; // moves searched with a reduced depth first
+	unsigned long long lmrResearches; // of those, the ones searched again at full depth
+	unsigned long long nullCutoffs; // nodes cut off by a verified null move
+	unsigned long long probCuts; // nodes cut off by ProbCut
+	unsigned long long tbHits; // positions found in the endgame tablebase
+};
+
+struct S_SearchContext /* state of one search, allocated once before the search starts */
+{
+	S_SearchStats stats;
+	S_SearchOptions options;
+	S_TransTable *table; // shared between searches, NULL to search without one
+	const S_Tablebase *tablebase; // probed at the nodes with few enough stones, NULL to search without one
+	const S_Network *network; // evaluates the leaves instead of evaluateBoard, NULL for the classic evaluation
+	S_Accumulator accumulators[MAX_PLY]; // first layer of the network for the position at every ply, when there is a network
+	bool timed; // whether the search stops at the deadline
+	const std::atomic<bool> *cancel; // the search stops once it is set, NULL when it can not be cancelled
+	bool stopped; // set when the deadline passed or the search was cancelled, the scores of the iteration are not valid anymore
+	std::chrono::steady_clock::time_point deadline;
+	S_Move pv[MAX_PLY][MAX_PLY]; // triangular table, pv[ply] is the best line found from ply
+	int pvLength[MAX_PLY];
+	S_Move killers[MAX_PLY][2]; // the last two quiet moves that cut off at each ply, newest first
+	int history[PLAYABLE_CELLS][PLAYABLE_CELLS]; // from, to: how often and how deep the move cut off
+	bool afterNull[MAX_PLY]; // the node at ply was reached by a null move, it must not make another one
+	int verifying; // above 0 while a null move fail high is verified, no null move is made meanwhile
+};
+
+struct S_SearchLimits /* how long iterativeDeepening searches, with how many threads and which pruning */
+{
+	S_SearchLimits() : milliseconds(-1), depth(MAX_PLY - 2), threads(1), cancel(NULL), tablebase(NULL), network(NULL) {}
+	int milliseconds; // time budget, -1 for none
+	int depth; // last iteration to search
+	int threads; // threads searching together (lazy SMP), at least 1
+	const std::atomic<bool> *cancel; // flag another thread sets to stop the search, NULL when it can not be cancelled
+	const S_Tablebase *tablebase; // endgame tablebase, NULL to search without one
+	const S_Network *network; // network evaluation, NULL for evaluateBoard
+	S_SearchOptions options; // pruning techniques used by every thread
+};
+
+struct S_SearchResult /* what a root search returns */
+{
+	S_Move move; // best move, not valid when pvLength is 0 (no legal moves)
+	int score; // score of the best move from the side to move's point of view
+	S_Move pv[MAX_PLY]; // principal variation, pv[0] is the best move
+	int pvLength;
+	int depth; // depth of the last completed iteration, 0 when the move was the only legal move
+	S_SearchStats stats; // summed over all threads
+};
+
+//MINMAX
+int miniMax(S_Position &position, int depth, int turn, S_SearchStats *stats = NULL);
+int alphaBeta(S_Position &position, int depth, int ply, int alpha, int beta, S_SearchContext &context);
+S_SearchResult searchRoot(const S_Position &position, int depth, S_TransTable *table = NULL, const S_SearchOptions &options = S_SearchOptions());
+S_SearchResult iterativeDeepening(const S_Position &position, const S_SearchLimits &limits, S_TransTable *table = NULL);
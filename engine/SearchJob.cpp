@@ -0,0 +1,125 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   SearchJob.cpp                                                            */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Background search implementation                                         */
+/*   so the GLUT loop never waits for the computer's search                   */
+/* ========================================================================== */
+
+#include "SearchJob.h"
+
+S_SearchJob::~S_SearchJob() {
+	cancelSearchJob(*this);
+}
+
+/**
+ * Starts searching a position on a worker thread, the call returns right away.
+ * The transposition table is used by the worker only, so it must not be touched until the job is taken or cancelled.
+ * @param job - A job that is not running.
+ * @param position - The position to search, copied, position.turn is the side to move.
+ * @param limits - Time budget, depth and threads of the search (see iterativeDeepening), the cancel flag is the job's.
+ * @param table - Transposition table kept between searches, NULL to search without one.
+ */
+void startSearchJob(S_SearchJob &job, const S_Position &position, const S_SearchLimits &limits, S_TransTable *table) {
+	cancelSearchJob(job);
+	job.running = true;
+	job.pondering = false;
+	job.cancelled = false;
+	job.finished = false;
+	job.positionHash = position.hash;
+	job.started = std::chrono::steady_clock::now();
+	S_SearchJob *handle = &job;
+	S_SearchLimits jobLimits = limits;
+	jobLimits.cancel = &job.cancelled;
+	job.worker = std::thread([handle, position, jobLimits, table]() {
+		handle->result = iterativeDeepening(position, jobLimits, table);
+		handle->finished.store(true, std::memory_order_release);
+	});
+}
+
+/**
+ * Starts a Monte Carlo tree search of a position on a worker thread, the call returns right away.
+ * The tree is used by the worker only, so it must not be touched until the job is taken or cancelled.
+ * @param job - A job that is not running.
+ * @param position - The position to search, copied, position.turn is the side to move.
+ * @param limits - Budgets, threads and playout policy of the search (see mctsSearch), the cancel flag is the job's.
+ * @param tree - Tree kept between searches.
+ */
+void startMctsJob(S_SearchJob &job, const S_Position &position, const S_MctsLimits &limits, S_MctsTree *tree) {
+	cancelSearchJob(job);
+	job.running = true;
+	job.pondering = false;
+	job.cancelled = false;
+	job.finished = false;
+	job.positionHash = position.hash;
+	job.started = std::chrono::steady_clock::now();
+	S_SearchJob *handle = &job;
+	S_MctsLimits jobLimits = limits;
+	jobLimits.cancel = &job.cancelled;
+	job.worker = std::thread([handle, position, jobLimits, tree]() {
+		handle->result = mctsSearch(position, jobLimits, *tree);
+		handle->finished.store(true, std::memory_order_release);
+	});
+}
+
+/**
+ * Makes a job ready with a result found without searching, a book move, so it is taken like a search result.
+ * @param job - A job that is not running.
+ * @param position - The position the result is for.
+ * @param result - The result takeSearchJobResult returns.
+ */
+void finishSearchJob(S_SearchJob &job, const S_Position &position, const S_SearchResult &result) {
+	cancelSearchJob(job);
+	job.running = true;
+	job.pondering = false;
+	job.cancelled = false;
+	job.positionHash = position.hash;
+	job.started = std::chrono::steady_clock::now();
+	job.result = result;
+	job.finished.store(true, std::memory_order_release);
+}
+
+/**
+ * Checks, without waiting, if the search finished.
+ * @param job - The job to poll.
+ * @return true when takeSearchJobResult will not wait.
+ */
+bool searchJobReady(const S_SearchJob &job) {
+	return job.running && job.finished.load(std::memory_order_acquire);
+}
+
+/**
+ * Waits for the worker and returns the result, the job is not running anymore afterwards.
+ * @param job - A running job, normally one searchJobReady returned true for.
+ * @return The search result.
+ */
+S_SearchResult takeSearchJobResult(S_SearchJob &job) {
+	if (job.worker.joinable())
+		job.worker.join();
+	job.running = false;
+	job.pondering = false;
+	return job.result;
+}
+
+/**
+ * Asks the search to stop and keeps its result, the best move of the last iteration it completed.
+ * Does not wait: poll searchJobReady, or call takeSearchJobResult which waits at most the time of 1024 nodes, or of one playout.
+ * @param job - A running job.
+ */
+void stopSearchJob(S_SearchJob &job) {
+	job.cancelled = true;
+}
+
+/**
+ * Stops the search and throws its result away, does nothing when the job is not running.
+ * Returns once the worker is gone, which takes at most the time of 1024 nodes, or of one playout.
+ * @param job - The job to cancel.
+ */
+void cancelSearchJob(S_SearchJob &job) {
+	job.cancelled = true;
+	if (job.worker.joinable())
+		job.worker.join();
+	job.running = false;
+	job.pondering = false;
+}
@@ -0,0 +1,39 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   SearchJob.h                                                              */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Computer search running on a worker thread                               */
+/*   polled by its owner, the game polls it from the idle callback            */
+/* ========================================================================== */
+#pragma once
+#include "Search.h"
+#include "Mcts.h"
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+struct S_SearchJob /* handle of one background search, owned and polled by the GUI thread */
+{
+	S_SearchJob() : running(false), pondering(false), cancelled(false), finished(false), positionHash(0) {}
+	~S_SearchJob();
+	S_SearchJob(const S_SearchJob &) = delete;
+	S_SearchJob &operator=(const S_SearchJob &) = delete;
+
+	bool running; // started and the result was not taken yet
+	bool pondering; // set by the owner for a search on the opponent's time, it has no time budget and runs until stopSearchJob
+	std::atomic<bool> cancelled; // set by the GUI thread, the search stops within 1024 nodes or one playout
+	std::atomic<bool> finished; // set by the worker once result is written
+	unsigned long long positionHash; // Zobrist key of the searched position
+	std::chrono::steady_clock::time_point started; // when the job was started
+	S_SearchResult result; // written by the worker, read only after finished is set
+	std::thread worker;
+};
+
+void startSearchJob(S_SearchJob &job, const S_Position &position, const S_SearchLimits &limits, S_TransTable *table);
+void startMctsJob(S_SearchJob &job, const S_Position &position, const S_MctsLimits &limits, S_MctsTree *tree);
+void finishSearchJob(S_SearchJob &job, const S_Position &position, const S_SearchResult &result);
+bool searchJobReady(const S_SearchJob &job);
+S_SearchResult takeSearchJobResult(S_SearchJob &job);
+void stopSearchJob(S_SearchJob &job);
+void cancelSearchJob(S_SearchJob &job);
@@ -0,0 +1,319 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Tablebase.cpp                                                            */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Endgame tablebase implementation                                         */
+/*   indexing of the slices and the probe of the mapped file                  */
+/* ========================================================================== */
+
+#include "Tablebase.h"
+#include "MappedFile.h"
+#include <string.h> // for memcpy
+
+#define MEN_SQUARES 28 /* a man is never on the row where it would be crowned */
+
+/*
+ * Binomial coefficients C(n, k), built at compile time.
+ * The stones of one kind are indexed as a combination of the squares they can stand on.
+ */
+struct S_Binomials
+{
+	unsigned long long value[PLAYABLE_CELLS + 1][TB_MAX_PIECES + 1];
+
+	constexpr S_Binomials() : value()
+	{
+		for (int n = 0; n <= PLAYABLE_CELLS; n++) {
+			value[n][0] = 1;
+			for (int k = 1; k <= TB_MAX_PIECES; k++)
+				value[n][k] = n == 0 ? 0 : value[n - 1][k - 1] + value[n - 1][k];
+		}
+	}
+};
+
+static constexpr S_Binomials binomials;
+static_assert(binomials.value[32][2] == 496 && binomials.value[28][3] == 3276, "C(32, 2) and C(28, 3)");
+
+/**
+ * Turns a mask by 180 degrees: square s becomes square 31 - s.
+ */
+static inline Bitboard rotateBoard(Bitboard bb) {
+	bb = ((bb >> 1) & 0x55555555u) | ((bb & 0x55555555u) << 1);
+	bb = ((bb >> 2) & 0x33333333u) | ((bb & 0x33333333u) << 2);
+	bb = ((bb >> 4) & 0x0F0F0F0Fu) | ((bb & 0x0F0F0F0Fu) << 4);
+	bb = ((bb >> 8) & 0x00FF00FFu) | ((bb & 0x00FF00FFu) << 8);
+	return (bb >> 16) | (bb << 16);
+}
+
+/**
+ * Index of a set of squares among all the sets of the same size: the sum of C(square - base, i + 1)
+ * over the squares in increasing order.
+ * @param squares - The set, every square at least base.
+ * @param base - The lowest square the stones can stand on.
+ */
+static unsigned long long combinationIndex(Bitboard squares, int base) {
+	unsigned long long index = 0;
+	for (int i = 1; squares; i++) {
+		index += binomials.value[lowestSquare(squares) - base][i];
+		squares &= squares - 1;
+	}
+	return index;
+}
+
+/**
+ * Inverse of combinationIndex.
+ * @param index - Index of the set, below C(n, count).
+ * @param count - Size of the set.
+ * @param base - The lowest square the stones can stand on.
+ * @param n - Number of squares they can stand on.
+ * @return The set.
+ */
+static Bitboard combinationSquares(unsigned long long index, int count, int base, int n) {
+	Bitboard squares = 0;
+	int c = n - 1;
+	for (int i = count; i > 0; i--) {
+		while (binomials.value[c][i] > index)
+			c--;
+		index -= binomials.value[c][i];
+		squares |= squareMask(c + base);
+		c--;
+	}
+	return squares;
+}
+
+/**
+ * Returns the position with PLAYER to move: a position with COMPUTER to move is turned with the colours swapped.
+ * @param position - Any position.
+ * @return The same game seen from the side to move as PLAYER, hash and score not updated.
+ */
+S_Position tbNormalize(const S_Position &position) {
+	if (position.turn == PLAYER)
+		return position;
+	S_Position normalized = position;
+	normalized.white = rotateBoard(position.black);
+	normalized.black = rotateBoard(position.white);
+	normalized.kings = rotateBoard(position.kings);
+	normalized.turn = PLAYER;
+	return normalized;
+}
+
+S_TbMaterial tbMaterial(const S_Position &normalized) {
+	S_TbMaterial material;
+	material.men = countSquares(normalized.white & ~normalized.kings);
+	material.kings = countSquares(normalized.white & normalized.kings);
+	material.otherMen = countSquares(normalized.black & ~normalized.kings);
+	material.otherKings = countSquares(normalized.black & normalized.kings);
+	return material;
+}
+
+/**
+ * Returns the index of a material in the slice offsets of a file.
+ * @param material - The stones, together at most maxPieces.
+ * @param maxPieces - The maxPieces of the file.
+ */
+int tbSliceKey(const S_TbMaterial &material, int maxPieces) {
+	const int n = maxPieces + 1;
+	return ((material.men * n + material.kings) * n + material.otherMen) * n + material.otherKings;
+}
+
+/**
+ * Returns the number of indexes of a slice, the positions where stones overlap included.
+ */
+unsigned long long tbSliceEntries(const S_TbMaterial &material) {
+	return binomials.value[MEN_SQUARES][material.men] * binomials.value[MEN_SQUARES][material.otherMen]
+		* binomials.value[PLAYABLE_CELLS][material.kings] * binomials.value[PLAYABLE_CELLS][material.otherKings];
+}
+
+/**
+ * Returns the index of a position in its slice: its men, the other side's men, its kings, the other side's kings,
+ * each a combination of the squares they can stand on. PLAYER men are never on row 0, COMPUTER men never on row 7.
+ * @param normalized - A position with PLAYER to move, see tbNormalize.
+ */
+unsigned long long tbIndex(const S_Position &normalized) {
+	const S_TbMaterial material = tbMaterial(normalized);
+	unsigned long long index = combinationIndex(normalized.white & ~normalized.kings, PLAYABLE_CELLS - MEN_SQUARES);
+	index = index * binomials.value[MEN_SQUARES][material.otherMen] + combinationIndex(normalized.black & ~normalized.kings, 0);
+	index = index * binomials.value[PLAYABLE_CELLS][material.kings] + combinationIndex(normalized.white & normalized.kings, 0);
+	index = index * binomials.value[PLAYABLE_CELLS][material.otherKings] + combinationIndex(normalized.black & normalized.kings, 0);
+	return index;
+}
+
+/**
+ * Inverse of tbIndex.
+ * @param material - The stones of the slice.
+ * @param index - Index in the slice, below tbSliceEntries(material).
+ * @param position - Receives the position with PLAYER to move, hash and score included.
+ * @return false when stones of the index stand on the same square, it is not a position.
+ */
+bool tbDecode(const S_TbMaterial &material, unsigned long long index, S_Position &position) {
+	const unsigned long long otherKingSets = binomials.value[PLAYABLE_CELLS][material.otherKings];
+	const unsigned long long kingSets = binomials.value[PLAYABLE_CELLS][material.kings];
+	const unsigned long long otherMenSets = binomials.value[MEN_SQUARES][material.otherMen];
+	const Bitboard otherKings = combinationSquares(index % otherKingSets, material.otherKings, 0, PLAYABLE_CELLS);
+	index /= otherKingSets;
+	const Bitboard kings = combinationSquares(index % kingSets, material.kings, 0, PLAYABLE_CELLS);
+	index /= kingSets;
+	const Bitboard otherMen = combinationSquares(index % otherMenSets, material.otherMen, 0, MEN_SQUARES);
+	index /= otherMenSets;
+	const Bitboard men = combinationSquares(index, material.men, PLAYABLE_CELLS - MEN_SQUARES, MEN_SQUARES);
+	if (countSquares(men | otherMen | kings | otherKings) != material.men + material.otherMen + material.kings + material.otherKings)
+		return false;
+	position.white = men | kings;
+	position.black = otherMen | otherKings;
+	position.kings = kings | otherKings;
+	position.turn = PLAYER;
+	position.hash = hashPosition(position);
+	position.score = scorePosition(position);
+	return true;
+}
+
+S_Tablebase::~S_Tablebase() {
+	tbClose(*this);
+}
+
+/**
+ * Maps a tablebase file into memory. Nothing is read or decoded: the pages are loaded by the probes that touch them.
+ * @param tablebase - Receives the mapping, the file it had is closed first.
+ * @param path - The file written by the tbgen tool.
+ * @return false when the file can not be opened or is not a tablebase, tablebase is then closed.
+ */
+bool tbOpen(S_Tablebase &tablebase, const char *path) {
+	tbClose(tablebase);
+	if (!mapFile(path, tablebase.data, tablebase.size))
+		return false;
+
+	// Check the header and that every slice header and block offset table is inside the file
+	S_TbHeader header;
+	bool valid = tablebase.size >= sizeof(header);
+	if (valid) {
+		memcpy(&header, tablebase.data, sizeof(header));
+		valid = header.magic == TB_MAGIC && header.version == TB_VERSION && header.maxPieces >= 2 && header.maxPieces <= TB_MAX_PIECES;
+	}
+	const size_t sliceCount = valid ? (size_t)(header.maxPieces + 1) * (header.maxPieces + 1) * (header.maxPieces + 1) * (header.maxPieces + 1) : 0;
+	valid = valid && tablebase.size >= sizeof(header) + sliceCount * sizeof(unsigned long long);
+	for (size_t i = 0; valid && i < sliceCount; i++) {
+		unsigned long long offset;
+		memcpy(&offset, tablebase.data + sizeof(header) + i * sizeof(offset), sizeof(offset));
+		if (offset == 0)
+			continue;
+		S_TbSliceHeader slice;
+		valid = offset + sizeof(slice) <= tablebase.size;
+		if (valid) {
+			memcpy(&slice, tablebase.data + offset, sizeof(slice));
+			valid = slice.blockCount == (slice.entries + TB_BLOCK_ENTRIES - 1) / TB_BLOCK_ENTRIES
+				&& offset + sizeof(slice) + (slice.blockCount + 1) * sizeof(unsigned int) <= tablebase.size;
+		}
+	}
+	if (!valid) {
+		tbClose(tablebase);
+		return false;
+	}
+	tablebase.maxPieces = (int)header.maxPieces;
+	return true;
+}
+
+/**
+ * Unmaps the file, does nothing when none is open. Must not be called while a search probes the tablebase.
+ */
+void tbClose(S_Tablebase &tablebase) {
+	unmapFile(tablebase.data, tablebase.size);
+	tablebase.data = NULL;
+	tablebase.size = 0;
+	tablebase.maxPieces = 0;
+}
+
+/**
+ * Finds the value of a position with a capture to play, which the file does not keep, from the positions the captures lead to.
+ * @param tablebase - An open tablebase.
+ * @param normalized - The position, PLAYER to move.
+ * @param moves - Its captures.
+ * @param distance - Receives the plies to the end of the game with best play, 0 for a draw.
+ * @return The result for the side to move.
+ */
+static E_TbResult probeCaptures(const S_Tablebase &tablebase, const S_Position &normalized, const S_MoveList &moves, int &distance) {
+	int shortestWin = -1, longestLoss = 0;
+	bool allLose = true;
+	for (int i = 0; i < moves.count; i++) {
+		S_Position next = normalized;
+		S_Undo undo;
+		applyMove(next, moves.moves[i], undo);
+		int nextDistance;
+		const E_TbResult result = tbProbe(tablebase, next, nextDistance);
+		if (result == TB_LOSS) {
+			if (shortestWin < 0 || nextDistance + 1 < shortestWin)
+				shortestWin = nextDistance + 1;
+		} else if (result == TB_WIN) {
+			if (nextDistance + 1 > longestLoss)
+				longestLoss = nextDistance + 1;
+		} else {
+			allLose = false;
+		}
+	}
+	if (shortestWin >= 0) {
+		distance = shortestWin;
+		return TB_WIN;
+	}
+	distance = allLose ? longestLoss : 0;
+	return allLose ? TB_LOSS : TB_DRAW;
+}
+
+/**
+ * Looks a position up: decodes the one block holding it, straight from the mapped file.
+ * A position with a capture to play is found through the positions its captures lead to.
+ * @param tablebase - An open tablebase, or a closed one that finds nothing.
+ * @param position - The position, either side to move.
+ * @param distance - Receives the plies to the end of the game with best play, 0 for a draw.
+ * @return The result for the side to move, TB_MISSING when the position has too many stones.
+ */
+E_TbResult tbProbe(const S_Tablebase &tablebase, const S_Position &position, int &distance) {
+	distance = 0;
+	if (!tablebase.data || countSquares(position.white | position.black) > tablebase.maxPieces)
+		return TB_MISSING;
+	const S_Position normalized = tbNormalize(position);
+	if (!normalized.white)
+		return TB_LOSS; // no stone left, the game is over
+	if (!normalized.black)
+		return TB_MISSING; // not a position of a game, the other side lost on the last move
+	S_MoveList moves;
+	generateMoves(normalized, PLAYER, moves);
+	if (isThereAttackMoves(moves)) {
+		filterAttackMoves(moves);
+		return probeCaptures(tablebase, normalized, moves, distance);
+	}
+
+	unsigned long long sliceOffset;
+	memcpy(&sliceOffset, tablebase.data + sizeof(S_TbHeader) + (size_t)tbSliceKey(tbMaterial(normalized), tablebase.maxPieces) * sizeof(sliceOffset), sizeof(sliceOffset));
+	if (!sliceOffset)
+		return TB_MISSING;
+	S_TbSliceHeader slice;
+	memcpy(&slice, tablebase.data + sliceOffset, sizeof(slice));
+	const unsigned char *blockOffsets = tablebase.data + sliceOffset + sizeof(slice);
+	const unsigned char *blocks = blockOffsets + (slice.blockCount + 1) * sizeof(unsigned int);
+
+	const unsigned long long index = tbIndex(normalized);
+	const unsigned long long block = index / TB_BLOCK_ENTRIES;
+	int entry = (int)(index % TB_BLOCK_ENTRIES);
+	unsigned int offset;
+	memcpy(&offset, blockOffsets + block * sizeof(offset), sizeof(offset));
+	const unsigned char *bytes = blocks + (offset & ~TB_BLOCK_KIND);
+	unsigned char value;
+	if ((offset & TB_BLOCK_KIND) == TB_RAW_BLOCK) {
+		value = bytes[entry];
+	} else if ((offset & TB_BLOCK_KIND) == TB_PALETTE_BLOCK) {
+		const int colours = bytes[0] + 1;
+		int bits = 0;
+		while ((1 << bits) < colours)
+			bits++;
+		const unsigned char *packed = bytes + 1 + colours;
+		const int bit = entry * bits;
+		const int word = packed[bit / 8] | (packed[bit / 8 + 1] << 8);
+		value = bytes[1 + ((word >> (bit % 8)) & ((1 << bits) - 1))];
+	} else {
+		while (entry > bytes[0]) { // (run length - 1, value) pairs
+			entry -= bytes[0] + 1;
+			bytes += 2;
+		}
+		value = bytes[1];
+	}
+	return tbDecodeValue(value, distance);
+}
@@ -0,0 +1,115 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Tablebase.h                                                              */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Endgame tablebase: win, loss or draw and the distance to the end         */
+/*   of every position with few stones, read from a memory-mapped file       */
+/* ========================================================================== */
+#pragma once
+#include "Position.h"
+#include <stddef.h> // for size_t
+
+#define TB_MAGIC 0x42544B43u /* "CKTB" read as a little endian int */
+#define TB_VERSION 1
+#define TB_MAX_PIECES 6 /* most stones of a table, both sides together: 7 stone slices reach 2.6e9 positions, */
+                         /* past what the 30 bits of a block offset address, and 8 stone ones tbgen's 32 bit indexes */
+#define TB_BLOCK_ENTRIES 256 /* entries compressed together, a probe decodes one block */
+#define TB_BLOCK_KIND 0xC0000000u /* high bits of a block offset: how the block is stored */
+#define TB_RUN_BLOCK 0x00000000u /* (run length - 1, value) pairs */
+#define TB_PALETTE_BLOCK 0x40000000u /* the count of distinct values - 1, the values, then an index in them per entry on the fewest bits */
+#define TB_RAW_BLOCK 0x80000000u /* one value per entry */
+#define TB_NOT_A_POSITION 255 /* value of an index where stones overlap, never probed */
+
+/*
+ * Every position is stored with PLAYER to move: a position with COMPUTER to move is turned by 180 degrees
+ * (square s becomes 31 - s) with the colours swapped, which gives the same game.
+ * The positions are split into slices by material, the stones of the side to move first.
+ *
+ * File layout, little endian:
+ *   S_TbHeader
+ *   unsigned long long sliceOffsets[(maxPieces + 1) ^ 4]  file offset of the S_TbSliceHeader of every material
+ *                                                          (see tbSliceKey), 0 for a material without a slice
+ *   for every slice: S_TbSliceHeader, unsigned int blockOffsets[blockCount + 1], the blocks
+ * A block offset counts from the end of blockOffsets, the kind of the block (TB_BLOCK_KIND) is or-ed in.
+ * The indexes of a palette block are packed from the lowest bit of each byte, followed by a padding byte.
+ * The values of the positions where the side to move has a capture are not kept, tbProbe plays the captures
+ * and probes the positions they lead to, which have fewer stones.
+ */
+struct S_TbHeader
+{
+	unsigned int magic; // TB_MAGIC
+	unsigned int version; // TB_VERSION
+	unsigned int maxPieces; // stones of the biggest slices
+	unsigned int reserved;
+};
+
+struct S_TbSliceHeader
+{
+	unsigned long long entries; // positions of the slice, see tbSliceEntries
+	unsigned long long blockCount;
+};
+
+struct S_TbMaterial /* stones of one slice */
+{
+	int men, kings; // of the side to move
+	int otherMen, otherKings; // of the other side
+};
+
+typedef enum
+{
+	TB_MISSING = -1, // the position is not in the tablebase
+	TB_LOSS = 0, // the side to move loses with best play of both sides
+	TB_DRAW = 1, // neither side can force a win
+	TB_WIN = 2 // the side to move wins
+} E_TbResult;
+
+struct S_Tablebase /* a tablebase file mapped into memory, read by all search threads */
+{
+	S_Tablebase() : data(NULL), size(0), maxPieces(0) {}
+	~S_Tablebase();
+	S_Tablebase(const S_Tablebase &) = delete;
+	S_Tablebase &operator=(const S_Tablebase &) = delete;
+	const unsigned char *data; // the whole file, NULL when none is open
+	size_t size;
+	int maxPieces;
+};
+
+bool tbOpen(S_Tablebase &tablebase, const char *path);
+void tbClose(S_Tablebase &tablebase);
+E_TbResult tbProbe(const S_Tablebase &tablebase, const S_Position &position, int &distance);
+
+// Indexing, shared by the probe and the generator
+S_Position tbNormalize(const S_Position &position); // the same position with PLAYER to move
+S_TbMaterial tbMaterial(const S_Position &normalized);
+int tbSliceKey(const S_TbMaterial &material, int maxPieces); // index of sliceOffsets
+unsigned long long tbSliceEntries(const S_TbMaterial &material);
+unsigned long long tbIndex(const S_Position &normalized); // index in the slice of tbMaterial(normalized)
+bool tbDecode(const S_TbMaterial &material, unsigned long long index, S_Position &position); // false where stones overlap
+
+/*
+ * A value is one byte: 0 a draw, 1 to 127 a win in 2 * value - 1 plies,
+ * 128 to 254 a loss in 2 * (value - 128) plies, the distance counting the plies to the end of the game.
+ */
+inline unsigned char tbEncodeValue(E_TbResult result, int distance)
+{
+	if (result == TB_WIN)
+		return (unsigned char)((distance + 1) / 2);
+	if (result == TB_LOSS)
+		return (unsigned char)(128 + distance / 2);
+	return 0;
+}
+
+inline E_TbResult tbDecodeValue(unsigned char value, int &distance)
+{
+	if (value == 0 || value == TB_NOT_A_POSITION) {
+		distance = 0;
+		return TB_DRAW;
+	}
+	if (value < 128) {
+		distance = 2 * value - 1;
+		return TB_WIN;
+	}
+	distance = 2 * (value - 128);
+	return TB_LOSS;
+}
@@ -0,0 +1,150 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Transposition.cpp                                                        */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Transposition table implementation                                       */
+/*   used by the alpha-beta search                                            */
+/* ========================================================================== */
+
+#include "Transposition.h"
+#include <string.h> // for memcpy
+
+static_assert(sizeof(S_TTData) == 8, "the data of an entry is one 64 bit word");
+static_assert(sizeof(S_TTEntry) == 16, "four entries fill a cache line");
+
+/**
+ * Packs the data of an entry in one word, so it can be written and read atomically.
+ */
+static inline unsigned long long packData(const S_TTData &data) {
+	unsigned long long word;
+	memcpy(&word, &data, sizeof(word));
+	return word;
+}
+
+static inline S_TTData unpackData(unsigned long long word) {
+	S_TTData data;
+	memcpy(&data, &word, sizeof(data));
+	return data;
+}
+
+S_TransTable::~S_TransTable() {
+	delete[] buckets;
+}
+
+/**
+ * Allocates the table, the old entries are lost. Must not be called while a search uses the table.
+ * @param table - The table to resize.
+ * @param megabytes - Memory to use, rounded down to a power of 2 number of buckets (at least one).
+ */
+void ttResize(S_TransTable &table, size_t megabytes) {
+	const size_t wanted = megabytes * 1024 * 1024 / sizeof(S_TTBucket);
+	size_t count = 1;
+	while (count * 2 <= wanted)
+		count *= 2;
+	delete[] table.buckets;
+	table.buckets = new S_TTBucket[count];
+	table.bucketCount = count;
+	ttClear(table);
+}
+
+/**
+ * Empties the table, used when a new game starts. Must not be called while a search uses the table.
+ * @param table - The table to clear.
+ */
+void ttClear(S_TransTable &table) {
+	for (size_t i = 0; i < table.bucketCount; i++)
+		for (int j = 0; j < TT_BUCKET_ENTRIES; j++) {
+			table.buckets[i].entry[j].keyXor.store(0, std::memory_order_relaxed);
+			table.buckets[i].entry[j].data.store(0, std::memory_order_relaxed);
+		}
+	table.generation = 0;
+}
+
+/**
+ * Marks the start of a new search, entries stored before it are replaced first.
+ * @param table - The table the search will use.
+ */
+void ttNewSearch(S_TransTable &table) {
+	table.generation = (table.generation + 1) & 63;
+}
+
+/**
+ * Looks up a position.
+ * @param table - The table to search.
+ * @param key - Zobrist key of the position.
+ * @param data - Receives the stored result when the position is found.
+ * @return true when the position was found.
+ */
+bool ttProbe(const S_TransTable &table, unsigned long long key, S_TTData &data) {
+	if (!table.buckets)
+		return false;
+	const S_TTBucket &bucket = table.buckets[key & (table.bucketCount - 1)];
+	for (int i = 0; i < TT_BUCKET_ENTRIES; i++) {
+		const unsigned long long word = bucket.entry[i].data.load(std::memory_order_relaxed);
+		if ((bucket.entry[i].keyXor.load(std::memory_order_relaxed) ^ word) == key) {
+			data = unpackData(word);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Stores a search result.
+ * Replacement policy, within the bucket of the key:
+ * 1. an entry of the same key is always overwritten, keeping its move when the new result has none;
+ * 2. otherwise an empty entry is used;
+ * 3. otherwise the entry of the oldest search is replaced, and among entries of the same search the shallowest one,
+ *    so deep results of the current search survive while results of moves played earlier in the game age out.
+ * Two threads storing into the same bucket at the same time may overwrite each other's result, which only costs a lookup.
+ * @param table - The table to store in.
+ * @param key - Zobrist key of the position.
+ * @param depth - Remaining depth the position was searched to.
+ * @param bound - Whether score is exact, a lower or an upper bound.
+ * @param score - The score from the side to move's point of view.
+ * @param move - The best move, S_Move() when there is none.
+ */
+void ttStore(S_TransTable &table, unsigned long long key, int depth, E_Bound bound, int score, const S_Move &move) {
+	if (!table.buckets)
+		return;
+	S_TTBucket &bucket = table.buckets[key & (table.bucketCount - 1)];
+	S_TTEntry *replace = &bucket.entry[0];
+	unsigned long long replaceKey = 0;
+	S_TTData replaceData = S_TTData();
+	int replaceWorth = 1 << 30;
+	for (int i = 0; i < TT_BUCKET_ENTRIES; i++) {
+		S_TTEntry &entry = bucket.entry[i];
+		const unsigned long long word = entry.data.load(std::memory_order_relaxed);
+		const unsigned long long entryKey = entry.keyXor.load(std::memory_order_relaxed) ^ word;
+		const S_TTData entryData = unpackData(word);
+		if (entryKey == key || entryKey == 0) {
+			replace = &entry;
+			replaceKey = entryKey;
+			replaceData = entryData;
+			break;
+		}
+		const int age = (table.generation - (entryData.boundAge >> 2)) & 63;
+		const int worth = entryData.depth - age * 256; // older searches first, then the shallowest
+		if (worth < replaceWorth) {
+			replaceWorth = worth;
+			replace = &entry;
+			replaceKey = entryKey;
+			replaceData = entryData;
+		}
+	}
+
+	S_TTData data = replaceData;
+	if (replaceKey != key || !isEmptyMove(move)) {
+		data.from = move.from;
+		data.to = move.to;
+		data.jumps = move.attack;
+		data.capturedFold = ttFoldCaptured(move.captured);
+	}
+	data.score = (short)score;
+	data.depth = (signed char)depth;
+	data.boundAge = (unsigned char)((table.generation << 2) | bound);
+	const unsigned long long word = packData(data);
+	replace->keyXor.store(key ^ word, std::memory_order_relaxed);
+	replace->data.store(word, std::memory_order_relaxed);
+}
@@ -0,0 +1,72 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   Transposition.h                                                          */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Transposition table of the computer's search                             */
+/*   keyed by the Zobrist hash of the position                                */
+/* ========================================================================== */
+#pragma once
+#include "Position.h"
+#include <stddef.h> // for size_t
+#include <atomic> // entries are shared by the search threads without locks
+
+#define TT_DEFAULT_MB 16 /* size of the table the game uses */
+#define TT_BUCKET_ENTRIES 4 /* entries sharing one index, one 64 byte cache line */
+
+typedef enum
+{
+	BOUND_NONE = 0,
+	BOUND_UPPER = 1, // the search failed low, the score is at most the stored score
+	BOUND_LOWER = 2, // the search failed high, the score is at least the stored score
+	BOUND_EXACT = 3 // the score is exact
+} E_Bound;
+
+struct S_TTData /* one stored search result, packed in 8 bytes */
+{
+	unsigned char from, to; // best move found, from == to and no jumps when there is none
+	unsigned char jumps; // opponent stones the best move jumps
+	unsigned char capturedFold; // jumped squares folded to 8 bits, tells apart captures with the same ends
+	short score; // from the side to move's point of view
+	signed char depth; // remaining depth the score was searched to
+	unsigned char boundAge; // E_Bound in the low 2 bits, generation of the search in the rest
+};
+
+/*
+ * Entries are written and read by all search threads without a lock.
+ * The key is stored xor-ed with the data word, so an entry torn by two threads writing it
+ * at the same time does not give back its own key, and ttProbe treats it as a miss.
+ */
+struct S_TTEntry /* 16 bytes */
+{
+	std::atomic<unsigned long long> keyXor; // Zobrist key ^ data, 0 when the entry is empty
+	std::atomic<unsigned long long> data; // S_TTData
+};
+
+struct S_TTBucket
+{
+	S_TTEntry entry[TT_BUCKET_ENTRIES];
+};
+
+struct S_TransTable /* fixed size table, allocated by ttResize and never grown while searching, shared by all search threads */
+{
+	S_TransTable() : buckets(NULL), bucketCount(0), generation(0) {}
+	~S_TransTable();
+	S_TTBucket *buckets;
+	size_t bucketCount; // power of 2, the index is the low bits of the key
+	unsigned char generation; // bumped by ttNewSearch, tells entries of old searches apart
+};
+
+void ttResize(S_TransTable &table, size_t megabytes);
+void ttClear(S_TransTable &table);
+void ttNewSearch(S_TransTable &table);
+bool ttProbe(const S_TransTable &table, unsigned long long key, S_TTData &data);
+void ttStore(S_TransTable &table, unsigned long long key, int depth, E_Bound bound, int score, const S_Move &move);
+
+inline E_Bound ttBound(const S_TTData &data) { return (E_Bound)(data.boundAge & 3); }
+inline unsigned char ttFoldCaptured(Bitboard captured) { captured ^= captured >> 16; return (unsigned char)(captured ^ (captured >> 8)); }
+inline bool ttHasMove(const S_TTData &data) { return data.from != data.to || data.jumps; }
+inline bool ttIsMove(const S_TTData &data, const S_Move &move) /* the stored best move is move, data must have a move */
+{
+	return data.from == move.from && data.to == move.to && data.jumps == move.attack && data.capturedFold == ttFoldCaptured(move.captured);
+}
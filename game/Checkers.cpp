@@ -47,15 +47,24 @@ Checkers::Checkers(const Checkers &copy) { //Copy constructor
 	event.z = copy.event.z;
 
 	result = copy.result;
+	MPSTATUS = copy.MPSTATUS;
 	stone_selected = copy.stone_selected;
 	isAnimating = copy.isAnimating;
-	for (int i = 0; i < BLOCK_CELLS; i++) {
-		block[i] = new S_CheckersBlock(copy.block[i]);
-	}
+	doneAnimatingCam = copy.doneAnimatingCam;
 	for (int i = 0; i < STONES_COUNT; i++) {
 		black[i] = new S_CheckersStone(copy.black[i]);
 		white[i] = new S_CheckersStone(copy.white[i]);
 	}
+	for (int i = 0; i < BLOCK_CELLS; i++) {
+		block[i] = new S_CheckersBlock(copy.block[i]);
+		// point the block to the copied stone, so the destructor frees every stone once
+		for (int j = 0; j < STONES_COUNT; j++) {
+			if (copy.block[i]->stone == copy.black[j])
+				block[i]->stone = black[j];
+			else if (copy.block[i]->stone == copy.white[j])
+				block[i]->stone = white[j];
+		}
+	}
 	stones_length = copy.stones_length;
 	stones_height = copy.stones_height;
 	stones_width = copy.stones_width;
@@ -489,12 +498,14 @@ void Checkers::init_game() /* this method used for stating the game */
 
 void Checkers::stop_game()  /* this method used for pausing the game */
 {
+	cancelSearchJob(search);
 	event.type = BOARD_GAME_IDLE;
 	doneAnimatingCam = 0;
 }
 
 void Checkers::reset_game()  /* this method used for resetting the game */
 {
+	cancelSearchJob(search);
 	for (S_CheckersBlock* checkers_block : block)
 		delete checkers_block;
 	for (S_CheckersStone* white_stone : white)
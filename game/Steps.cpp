@@ -7,1599 +7,446 @@
 /*   used in the checkers class			    			                      */
 /* ========================================================================== */
 
+#include "../multiplayer/multiplayer.h" // first, winsock2.h must come before the windows.h GLUT includes
 #include "Steps.h"
+#include <random> // for the pick among the book moves
+#include <string.h> // for memcmp
 
 
 /**
- * MiniMax algorithm implementation.
+ * Reads the Checkers board into a bitboard position for the search.
  * @param checkers - The current state of the checkers game.
- * @param depth - The depth to which the algorithm should explore.
- * @param turn - The current player's turn (1 for maximizing player, 0 for minimizing player).
- * @return The evaluation score of the board.
+ * @param turn - The side to move in the position.
+ * @return The position of the stones on the board.
  */
-int miniMax(Checkers checkers, int depth, int turn) {
-	// Base case: if we've reached the maximum depth, evaluate the board
-	if (depth == 0)
-		return evaluateBoard(checkers);
+S_Position positionFromCheckers(const Checkers &checkers, int turn) {
+	S_Position position;
+	position.white = 0;
+	position.black = 0;
+	position.kings = 0;
+	position.turn = turn == COMPUTER ? COMPUTER : PLAYER;
 
-	if (turn) {
-		// Maximizing player (assumed to be player with 'turn == 1')
-
-		int bestValue = -_CRT_INT_MAX; // Initialize to the smallest possible value
-		Step *stepRoot = generateMoves(checkers, turn); // Generate all possible moves
-		if (isThereAttackMoves(stepRoot)) // Filter attack moves if available
-			stepRoot = filterAttackMoves(stepRoot);
-		Step *step = stepRoot;
-
-		// Iterate through all possible moves
-		while (step) {
-			Checkers check = applyMove(checkers, step); // Apply the move and get the new board state
-			int value = miniMax(check, depth - 1, PLAYER); // Recursively call miniMax for the opponent
-			if (value > bestValue) { // Choose the maximum value
-				bestValue = value;
-			}
-			step = step->next;
+	for (int row = 0; row < checkers.event.cells_per_row; row++)
+		for (int col = 0; col < checkers.event.cells_per_row; col++) {
+			const S_CheckersBlock *block = checkers.block[row * checkers.event.cells_per_row + col];
+			if (block->isEmpty || block->stone == nullptr)
+				continue;
+			const Bitboard square = squareMask(squareIndex(row, col));
+			if (block->turn == COMPUTER)
+				position.black |= square;
+			else
+				position.white |= square;
+			if (block->stone->state == STONE_KING)
+				position.kings |= square;
 		}
-		releaseStep(stepRoot); // Free the memory allocated for moves
-		return bestValue; // Return the best value found
-	} else {
-		// Minimizing player (assumed to be player with 'turn == 0')
+	position.hash = hashPosition(position);
+	position.score = scorePosition(position);
+	return position;
+}
 
-		int bestValue = _CRT_INT_MAX; // Initialize to the largest possible value
-		Step *stepRoot = generateMoves(checkers, turn); // Generate all possible moves
-		if (isThereAttackMoves(stepRoot)) // Filter attack moves if available
-			stepRoot = filterAttackMoves(stepRoot);
-		Step *step = stepRoot;
+static S_TransTable transTable; // kept between the computer's moves, allocated on the first search
+S_SearchOptions computerSearchOptions; // pruning of the HARD search, switched from the keyboard
+bool computerPondering = true; // the HARD computer searches on the player's time, switched from the keyboard
+static S_MctsTree mctsTree; // kept between the computer's moves in MCTS mode, allocated on the first search
+static S_Tablebase tablebase; // mapped with the allocation of transTable, stays closed when there is no TABLEBASE_FILE
+static S_Book book; // mapped with the allocation of transTable, stays closed when there is no BOOK_FILE
+static S_Network network; // read with the allocation of transTable when there is a NETWORK_FILE
+static bool networkLoaded = false;
+bool computerNetwork = true; // the HARD computer evaluates with the network when it is loaded, switched from the keyboard
 
-		// Iterate through all possible moves
-		while (step) {
-			Checkers check = applyMove(checkers, step); // Apply the move and get the new board state
-			int value = miniMax(check, depth - 1, COMPUTER); // Choose the minimum value
-			if (value < bestValue) {
-				bestValue = value;
-			}
-			step = step->next;
-		}
-		releaseStep(stepRoot); // Free the memory allocated for moves
-		return bestValue; // Return the best value found
-	}
+/**
+ * Allocates the transposition table, maps the tablebase and the book and reads the network, once, before the first HARD move.
+ */
+static void openComputerTables() {
+	if (transTable.buckets)
+		return;
+	ttResize(transTable, TT_DEFAULT_MB);
+	if (tbOpen(tablebase, TABLEBASE_FILE))
+		printf("endgame tablebase %s: up to %d stones\n", TABLEBASE_FILE, tablebase.maxPieces);
+	if (bookOpen(book, BOOK_FILE))
+		printf("opening book %s: %llu moves\n", BOOK_FILE, (unsigned long long)book.count);
+	networkLoaded = nnLoad(network, NETWORK_FILE);
+	if (networkLoaded)
+		printf("evaluation network %s\n", NETWORK_FILE);
 }
 
 /**
- * Applies a move to the checkers board and returns the new board state.
- * @param checkers - The current state of the checkers game.
- * @param step - The move to apply.
- * @return The new state of the checkers game after applying the move.
+ * Returns the number of threads the computer searches with, COMPUTER_THREADS or one per core.
  */
-Checkers applyMove(Checkers checkers, Step *step) {
-
-	Checkers temp(checkers); // Create a copy of the current board state
-
-	// Move the stone to the new position
-	temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->stone = temp.block[(step->oldrow)* temp.event.cells_per_row + step->oldcol]->stone;
-
-	// Set the animation parameters
-	temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->stone->isAnimating = true;
-	temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->stone->animx = temp.block[(step->oldrow)* temp.event.cells_per_row + step->oldcol]->x + temp.stones_length;
-	temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->stone->animy = temp.block[(step->oldrow)* temp.event.cells_per_row + step->oldcol]->y + temp.stones_height;
-	temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->stone->animz = temp.block[(step->oldrow)* temp.event.cells_per_row + step->oldcol]->z + temp.stones_width;
+static int computerThreads() {
+	const int threads = COMPUTER_THREADS > 0 ? COMPUTER_THREADS : (int)std::thread::hardware_concurrency();
+	return threads < 1 ? 1 : threads; // hardware_concurrency is 0 when it can not tell
+}
 
-	// Update the board state
-	temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->isEmpty = temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->isEmpty;
-	temp.block[(step->oldrow)* temp.event.cells_per_row + step->oldcol]->isEmpty = true;;
+/**
+ * Returns the limits of the computer's searches: pruning, threads and evaluation, with the given time budget.
+ * @param milliseconds - Time budget, -1 for none.
+ */
+static S_SearchLimits computerSearchLimits(int milliseconds) {
+	S_SearchLimits limits;
+	limits.milliseconds = milliseconds;
+	limits.options = computerSearchOptions;
+	limits.threads = computerThreads();
+	limits.tablebase = tablebase.data ? &tablebase : NULL;
+	limits.network = networkLoaded && computerNetwork ? &network : NULL;
+	return limits;
+}
 
-	temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->turn = temp.block[(step->oldrow)* temp.event.cells_per_row + step->oldcol]->turn;
-	temp.block[(step->oldrow)* temp.event.cells_per_row + step->oldcol]->turn = EMPTY;
+/**
+ * Looks a position up in the opening book, picking one of its book moves at random by their weights.
+ * @param position - The position on the board, COMPUTER to move.
+ * @param result - Receives the book move, with depth 0 and no score.
+ * @return false when the position is not in the book.
+ */
+static bool getBookMove(const S_Position &position, S_SearchResult &result) {
+	static std::mt19937 random(std::random_device{}()); // 32 bits: rand() gives 15 on MSVC, fewer than the weights can sum to
+	S_Move move;
+	if (!bookProbe(book, position, (unsigned int)random(), move))
+		return false;
+	result.move = result.pv[0] = move;
+	result.pvLength = 1;
+	result.depth = 0;
+	result.score = 0;
+	result.stats = S_SearchStats();
+	char text[MOVE_TEXT_SIZE];
+	moveToText(position, move, text);
+	printf("book: %s\n", text);
+	return true;
+}
 
-	temp.block[(step->oldrow)* temp.event.cells_per_row + step->oldcol]->stone = nullptr;
+/**
+ * Starts the computer's search on a worker thread, in HARD and MCTS mode only.
+ * Does nothing when the search is already running, so it can be called every frame.
+ * In HARD mode a position of the opening book is not searched: its book move is stored as the result of the job.
+ * A ponder search of the position on the board goes on as the search of the move,
+ * a ponder search of another position is cancelled, what it stored in the transposition table is kept.
+ * @param checkers - The current state of the checkers game, COMPUTER to move.
+ */
+void startComputerSearch(Checkers &checkers) {
+	if (checkers.event.difficulty == MCTS) {
+		if (checkers.search.running)
+			return;
+		S_MctsLimits limits;
+		limits.milliseconds = COMPUTER_MCTS_PLAYOUTS > 0 ? -1 : COMPUTER_MOVE_MS;
+		limits.playouts = COMPUTER_MCTS_PLAYOUTS;
+		limits.threads = computerThreads();
+		startMctsJob(checkers.search, positionFromCheckers(checkers, COMPUTER), limits, &mctsTree);
+		return;
+	}
+	if (checkers.event.difficulty != HARD || (checkers.search.running && !checkers.search.pondering))
+		return; // searching the move already, or its book move is waiting to be taken
+	openComputerTables();
+
+	// Sync the board once, the search runs on its own copy of the bitboard position
+	const S_Position position = positionFromCheckers(checkers, COMPUTER);
+	S_SearchResult bookResult;
+	if (getBookMove(position, bookResult)) { // played instead of a ponder hit too
+		finishSearchJob(checkers.search, position, bookResult);
+		return;
+	}
+	if (checkers.search.running) {
+		if (checkers.search.positionHash == position.hash)
+			return; // the player played the expected reply
+		cancelSearchJob(checkers.search);
+	}
+	startSearchJob(checkers.search, position, computerSearchLimits(COMPUTER_MOVE_MS), &transTable);
+}
 
-	// Handle promotion to king
-	if (step->newrow == 0 && temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->stone->type == WHITE)
-		temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->stone->state = STONE_KING;
-	if (step->newrow == 7 && temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->stone->type == BLACK)
-		temp.block[(step->newrow)* temp.event.cells_per_row + step->newcol]->stone->state = STONE_KING;
+/**
+ * Starts searching, on the player's time, the position after the reply the computer's search expects,
+ * so the computer's next move is ready when the player plays it.
+ * @param checkers - The current state of the checkers game, after the computer's move.
+ * @param result - The search result of the computer's move, pv[1] is the expected reply.
+ */
+static void startPonderSearch(Checkers &checkers, const S_SearchResult &result) {
+	if (!computerPondering || result.pvLength < 2)
+		return;
+	S_Position position = positionFromCheckers(checkers, PLAYER);
+	S_MoveList moves;
+	generateMoves(position, PLAYER, moves);
+	if (isThereAttackMoves(moves))
+		filterAttackMoves(moves);
+	for (int i = 0; i < moves.count; i++)
+		if (sameMove(moves.moves[i], result.pv[1])) {
+			S_Undo undo;
+			applyMove(position, moves.moves[i], undo);
+			startSearchJob(checkers.search, position, computerSearchLimits(-1), &transTable);
+			checkers.search.pondering = true;
+			return;
+		}
+}
 
+/**
+ * Determines the best move for the computer using the alpha-beta search,
+ * deepened until COMPUTER_MOVE_MS milliseconds are used on COMPUTER_THREADS worker threads,
+ * or in MCTS mode the Monte Carlo tree search, until COMPUTER_MOVE_MS or COMPUTER_MCTS_PLAYOUTS are used.
+ * In HARD mode a position of the opening book is not searched, its book move is played.
+ * After a ponder hit the search started on the player's time is stopped once it ran COMPUTER_MOVE_MS,
+ * which it most often has by the time the player moved.
+ * Never waits: the first call starts the search, the calls after it poll it.
+ * @param checkers - The current state of the checkers game, COMPUTER to move.
+ * @param result - Receives the search result holding the best move, its score and the principal variation.
+ * @return true when result was filled in, false while the search is still running.
+ */
+bool getBestMove(Checkers &checkers, S_SearchResult &result) {
+	startComputerSearch(checkers);
+	const bool ponderHit = checkers.search.pondering;
+	if (ponderHit && !searchJobReady(checkers.search)) {
+		if (std::chrono::steady_clock::now() - checkers.search.started < std::chrono::milliseconds(COMPUTER_MOVE_MS))
+			return false;
+		stopSearchJob(checkers.search);
+	}
+	if (!searchJobReady(checkers.search))
+		return false;
+	result = takeSearchJobResult(checkers.search);
+	if (checkers.search.positionHash != positionFromCheckers(checkers, COMPUTER).hash)
+		return false; // the board changed while searching, search it again
+	if (ponderHit && result.pvLength == 0) {
+		startComputerSearch(checkers);
+		return false; // stopped before completing an iteration, search the move on the computer's time
+	}
 
-	// Handle attack moves	
-	if (step->attack) {
-		temp.block[(step->attackrow) * temp.event.cells_per_row + step->attackcol]->stone->y = temp.event.y - 1;
-		temp.block[(step->attackrow) * temp.event.cells_per_row + step->attackcol]->turn = EMPTY;
-		temp.block[(step->attackrow) * temp.event.cells_per_row + step->attackcol]->isEmpty = true;
-		temp.block[(step->attackrow) * temp.event.cells_per_row + step->attackcol]->stone = nullptr;
+	const S_SearchStats &stats = result.stats;
+	if (checkers.event.difficulty == MCTS) {
+		printf("mcts: %llu playouts | win rate %.1f%% | line of %d moves\n",
+			stats.nodes, 50.0 + 50.0 * result.score / MCTS_SCORE_SCALE, result.pvLength);
+		return true;
 	}
-	return temp; // Return the new board state
+	if (result.depth == 0 && stats.nodes == 0)
+		return true; // nothing was searched: a book move, printed when it was looked up, or the only legal move
+	printf("search%s: depth %d | %llu nodes | tt hits %.1f%% of %llu probes | tt cutoffs %llu | first move cutoffs %.1f%% | lmr %llu (%llu again) | null %llu | probcut %llu | tb hits %llu\n",
+		ponderHit ? " (ponder hit)" : "", result.depth, stats.nodes,
+		stats.ttProbes ? 100.0 * stats.ttHits / stats.ttProbes : 0.0, stats.ttProbes, stats.ttCutoffs,
+		stats.betaCutoffs ? 100.0 * stats.firstMoveCutoffs / stats.betaCutoffs : 0.0,
+		stats.lmrReductions, stats.lmrResearches, stats.nullCutoffs, stats.probCuts, stats.tbHits);
+	return true;
 }
 
 /**
- * Evaluates the board state and returns a score based on the positions of the stones.
+ * Generates all possible moves for the given player on the Checkers board.
  * @param checkers - The current state of the checkers game.
- * @return The evaluation score of the board.
+ * @param turn - The player to generate moves for (PLAYER or COMPUTER).
+ * @param moves - Receives the moves, count is 0 if there are none.
  */
-int evaluateBoard(Checkers &checkers) {
-	int whiteStones = 0, blackStones = 0;
-
-	// Iterate through the board and calculate the score
-	for (int row = 0; row < checkers.event.cells_per_row; row++)
-		for (int col = 0; col < checkers.event.cells_per_row; col++) {
-			if (!checkers.block[row + col * checkers.event.cells_per_row]->isEmpty) {
-				if (checkers.block[row + col * checkers.event.cells_per_row]->stone != nullptr) {
-					if (checkers.block[row + col * checkers.event.cells_per_row]->stone->type == WHITE) {
-						if (checkers.block[row + col * checkers.event.cells_per_row]->stone->state == STONE_KING) {
-							whiteStones += 10; // King stones are more valuable
-						} else {
-							whiteStones += checkers.event.cells_per_row - row; // Regular stones are valued based on their row
-						}
-					} else {
-						if (checkers.block[row + col * checkers.event.cells_per_row]->stone->state == STONE_KING) {
-							blackStones += 10;  // King stones are more valuable
-						} else {
-							blackStones += row; // Regular stones are valued based on their row
-						}
-					}
-				}
-			}
-		}
-	/*for (auto& i : checkers.block) {
-			if (i->stone != NULL)
-					if (!i->isEmpty)
-							if (i->stone->type == WHITE)
-									if (i->state == STONE_KING)
-											whiteStones += 2;
-									else
-											whiteStones++;
-							else if (i->stone->type == BLACK)
-									if (i->state == STONE_KING)
-											blackStones += 2;
-									else
-											blackStones++;
-	}*/
-	return whiteStones - blackStones; // Return the difference in scores
+void generateMoves(Checkers &checkers, int turn, S_MoveList &moves) {
+	generateMoves(positionFromCheckers(checkers, turn), turn, moves);
 }
 
 /**
- * Determines the best move for the computer using the MiniMax algorithm.
+ * Takes the stones jumped by a capture off the board.
  * @param checkers - The current state of the checkers game.
- * @param turn - The turn indicator (0 for PLAYER, 1 for COMPUTER).
- * @return A pointer to the best move.
+ * @param captured - The squares of the jumped stones, 0 for a simple move.
  */
-Step *getBestMove(Checkers checkers, int turn) {
-	// Generate all possible moves for the computer
-	Step *stepRoot = generateMoves(checkers, COMPUTER);
-
-	// Filter to only attack moves if any exist
-	if (isThereAttackMoves(stepRoot))
-		stepRoot = filterAttackMoves(stepRoot);
+static void removeCapturedStones(Checkers &checkers, Bitboard captured) {
+	for (; captured; captured &= captured - 1) {
+		const int square = lowestSquare(captured);
+		S_CheckersBlock *block = checkers.block[squareRow(square) * checkers.event.cells_per_row + squareCol(square)];
+		block->stone->y = checkers.event.y - 1;
+		block->turn = EMPTY;
+		block->isEmpty = true;
+		block->stone = nullptr;
+	}
+}
 
-	Step *step = stepRoot;
+/**
+ * Plays a whole move of the computer on the board, all the stones of a capture are taken at once.
+ * @param checkers - The current state of the checkers game, COMPUTER to move.
+ * @param move - A legal move of the COMPUTER.
+ */
+static void moveComputerStone(Checkers &checkers, const S_Move &move) {
+	int oldrow = squareRow(move.from), oldcol = squareCol(move.from),
+		newrow = squareRow(move.to), newcol = squareCol(move.to);
 
-	// Perform the MiniMax algorithm with a depth of 3
-	int minimaxResult = miniMax(checkers, 3, COMPUTER);
+	removeCapturedStones(checkers, move.captured);
 
-	// Iterate through all possible moves to find the best one
-	while (step) {
-		//printf("POSSIBLE MOVE: oldcol: %d - oldow: %d | newcol: %d - newrow: %d | attack = %d\n", step->oldcol, step->oldrow, step->newcol, step->newrow, step->attack);
+	if (move.from != move.to) { // a king's capture may end where it started
+		checkers.block[(newrow)* checkers.event.cells_per_row + newcol]->stone = checkers.block[(oldrow)* checkers.event.cells_per_row + oldcol]->stone;
 
-		// Apply the current move and evaluate the board state
-		Checkers check = applyMove(checkers, step);
-		int evalresult = miniMax(check, 2, COMPUTER);
+		checkers.block[(newrow)* checkers.event.cells_per_row + newcol]->isEmpty = checkers.block[(oldrow)* checkers.event.cells_per_row + oldcol]->isEmpty;
+		checkers.block[(oldrow)* checkers.event.cells_per_row + oldcol]->isEmpty = true;;
 
-		//printf("MAX: %d EVAL: %d\n", minimaxResult, evalresult);
+		checkers.block[(newrow)* checkers.event.cells_per_row + newcol]->turn = checkers.block[(oldrow)* checkers.event.cells_per_row + oldcol]->turn;
+		checkers.block[(oldrow)* checkers.event.cells_per_row + oldcol]->turn = EMPTY;
 
-		// If the evaluated result matches the best MiniMax result, break
-		if (evalresult == minimaxResult)
-			break;
-		step = step->next;
+		checkers.block[(oldrow)* checkers.event.cells_per_row + oldcol]->stone = nullptr;
 	}
 
-	// If no specific best move was found, default to the first move
-	if (step == nullptr)
-		step = stepRoot;
+	checkers.block[(newrow)* checkers.event.cells_per_row + newcol]->stone->isAnimating = true;
+	checkers.block[(newrow)* checkers.event.cells_per_row + newcol]->stone->animx = checkers.block[(newrow)* checkers.event.cells_per_row + newcol]->x + checkers.stones_length;
+	checkers.block[(newrow)* checkers.event.cells_per_row + newcol]->stone->animy = checkers.block[(newrow)* checkers.event.cells_per_row + newcol]->y + checkers.stones_height;
+	checkers.block[(newrow)* checkers.event.cells_per_row + newcol]->stone->animz = checkers.block[(newrow)* checkers.event.cells_per_row + newcol]->z + checkers.stones_width;
 
-	// Allocate memory for the new best move step
-	Step *newStep = (Step*)malloc(sizeof(Step));
-	newStep = &Step(step);
+	checkers.event.turn = PLAYER;
 
-	// Release the memory allocated for the list of possible moves
-	releaseStep(stepRoot);
-	
-	//printf("BEST MOVE: oldcol: %d - oldow: %d | newcol: %d - newrow: %d | attack = %d\n", newStep->oldcol, newStep->oldrow, newStep->newcol, newStep->newrow, newStep->attack);
-
-	return newStep;
+	if (newrow == 7)
+		checkers.block[(newrow)* checkers.event.cells_per_row + newcol]->stone->state = STONE_KING;
 }
 
 /**
- * Generates all possible moves for the given player.
- * @param checkers - The current state of the checkers game.
- * @param turn - The current player's turn (1 for maximizing player, 0 for minimizing player).
- * @return A linked list of possible moves.
+ * Plays a whole move of the player on the board and, in MULTIPLAYER mode, sends it to the server hop by hop.
+ * @param checkers - The current state of the checkers game, PLAYER to move.
+ * @param move - A legal move of the PLAYER.
  */
-Step *generateMoves(Checkers &checkers, int turn) {
+static void movePlayerStone(Checkers &checkers, const S_Move &move) {
+	int row1 = squareRow(move.from), col1 = squareCol(move.from),
+		row = squareRow(move.to), col = squareCol(move.to);
+	unsigned char path[MAX_JUMPS]; // landing squares of the hops, sent to the server one by one
+	const int hops = movePath(positionFromCheckers(checkers, PLAYER), move, path);
+	removeCapturedStones(checkers, move.captured);
 
-	Step *root = (Step*)malloc(sizeof(Step));
-	Step *current = root;
-	root->oldcol = NULL;
-	root->oldrow = NULL;
-	root->newcol = NULL;
-	root->newrow = NULL;
-	root->attack = NULL;
-	root->attackcol = NULL;
-	root->attackrow = NULL;
-	root->next = NULL;
+	if (move.from != move.to) { // a king's capture may end where it started
+		checkers.block[(row)* checkers.event.cells_per_row + col]->stone = checkers.block[(row1)* checkers.event.cells_per_row + col1]->stone;
 
-	// Iterate through the board to generate moves
-	if (turn == COMPUTER) {
-		for (int row = 0; row < 8; row++) {
-			for (int col = 0; col < 8; col++) {
-				if (checkers.block[row * checkers.event.cells_per_row + col]->turn == COMPUTER) {
-					if (checkers.block[row * checkers.event.cells_per_row + col]->stone->state == STONE_KING) { //if king
-						if (col == 7 || col == 0 || row == 0 || row == 7) { //if on edge
-							if (col == 0 && row == 0) { // can move right down only
-								if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-									if (checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row + 2 <= 7 && col + 2 <= 7) { //doesn't go out of bounds
-											if (checkers.block[(row + 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col + 2;
-												step->newrow = row + 2;
-												step->attack = 1;
-												step->attackcol = col + 1;
-												step->attackrow = row + 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row + 1 <= 7) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col + 1;
-										step->newrow = row + 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							} else if (col == 0 && row == 7) { //can move right up only
-								if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-									if (checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row - 2 >= 0 && col + 2 <= 7) { //doesn't go out of bounds
-											if (checkers.block[(row - 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col + 2;
-												step->newrow = row - 2;
-												step->attack = 1;
-												step->attackcol = col + 1;
-												step->attackrow = row - 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row - 1 >= 0) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col + 1;
-										step->newrow = row - 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							} else if (col == 7 && row == 0) { //can move left up only
-								if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-									if (checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row + 2 <= 7 && col - 2 >= 0) { //doesn't go out of bounds
-											if (checkers.block[(row + 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col - 2;
-												step->newrow = row + 2;
-												step->attack = 1;
-												step->attackcol = col - 1;
-												step->attackrow = row + 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row + 1 <= 7) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col - 1;
-										step->newrow = row + 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							} else if (col == 7 && row == 7) { //can move left down only
-								if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-									if (checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row - 2 >= 0 && col - 2 >= 0) { //doesn't go out of bounds
-											if (checkers.block[(row - 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col - 2;
-												step->newrow = row - 2;
-												step->attack = 1;
-												step->attackcol = col - 1;
-												step->attackrow = row - 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row - 1 >= 0) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col - 1;
-										step->newrow = row - 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							} else {
-								if (col == 0) { //can move right only
-									if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-										if (checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row + 2 <= 7 && col + 2 <= 7) { //doesn't go out of bounds
-												if (checkers.block[(row + 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col + 2;
-													step->newrow = row + 2;
-													step->attack = 1;
-													step->attackcol = col + 1;
-													step->attackrow = row + 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row + 1 <= 7) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 1;
-											step->newrow = row + 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-									if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-										if (checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row - 2 >= 0 && col + 2 <= 7) { //doesn't go out of bounds
-												if (checkers.block[(row - 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col + 2;
-													step->newrow = row - 2;
-													step->attack = 1;
-													step->attackcol = col + 1;
-													step->attackrow = row - 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row - 1 >= 0) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 1;
-											step->newrow = row - 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								} else if (col == 7) { //can move left only
-									if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-										if (checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row + 2 <= 7 && col - 2 >= 0) { //doesn't go out of bounds
-												if (checkers.block[(row + 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col - 2;
-													step->newrow = row + 2;
-													step->attack = 1;
-													step->attackcol = col - 1;
-													step->attackrow = row + 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row + 1 <= 7) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 1;
-											step->newrow = row + 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-									if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-										if (checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row - 2 >= 0 && col - 2 >= 0) { //doesn't go out of bounds
-												if (checkers.block[(row - 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col - 2;
-													step->newrow = row - 2;
-													step->attack = 1;
-													step->attackcol = col - 1;
-													step->attackrow = row - 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row - 1 >= 0) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 1;
-											step->newrow = row - 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-								if (row == 0) { // can move down only
-									if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-										if (checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row + 2 <= 7 && col - 2 >= 0) { //doesn't go out of bounds
-												if (checkers.block[(row + 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col - 2;
-													step->newrow = row + 2;
-													step->attack = 1;
-													step->attackcol = col - 1;
-													step->attackrow = row + 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row + 1 <= 7) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 1;
-											step->newrow = row + 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-									if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-										if (checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row + 2 <= 7 && col + 2 <= 7) { //doesn't go out of bounds
-												if (checkers.block[(row + 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col + 2;
-													step->newrow = row + 2;
-													step->attack = 1;
-													step->attackcol = col + 1;
-													step->attackrow = row + 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row + 1 <= 7) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 1;
-											step->newrow = row + 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								} else if (row == 7) { //can move up only
-									if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-										if (checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row - 2 >= 0 && col - 2 >= 0) { //doesn't go out of bounds
-												if (checkers.block[(row - 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col - 2;
-													step->newrow = row - 2;
-													step->attack = 1;
-													step->attackcol = col - 1;
-													step->attackrow = row - 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row - 1 >= 0) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 1;
-											step->newrow = row - 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-									if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-										if (checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row - 2 >= 0 && col + 2 <= 7) { //doesn't go out of bounds
-												if (checkers.block[(row - 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col + 2;
-													step->newrow = row - 2;
-													step->attack = 1;
-													step->attackcol = col + 1;
-													step->attackrow = row - 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row + 1 <= 7) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 1;
-											step->newrow = row - 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							}
-						} else { //if not on edge
-							if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-								if (checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row + 2 <= 7 && col + 2 <= 7) { //doesn't go out of bounds
-										if (checkers.block[(row + 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 2;
-											step->newrow = row + 2;
-											step->attack = 1;
-											step->attackcol = col + 1;
-											step->attackrow = row + 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row + 1 <= 7) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col + 1;
-									step->newrow = row + 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
+		checkers.block[(row)* checkers.event.cells_per_row + col]->isEmpty = checkers.block[(row1)* checkers.event.cells_per_row + col1]->isEmpty;
+		checkers.block[(row1)* checkers.event.cells_per_row + col1]->isEmpty = true;;
 
-							if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-								if (checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row + 2 <= 7 && col - 2 >= 0) { //doesn't go out of bounds
-										if (checkers.block[(row + 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 2;
-											step->newrow = row + 2;
-											step->attack = 1;
-											step->attackcol = col - 1;
-											step->attackrow = row + 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row + 1 <= 7) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col - 1;
-									step->newrow = row + 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
-							if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-								if (checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row - 2 >= 0 && col + 2 <= 7) { //doesn't go out of bounds
-										if (checkers.block[(row - 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 2;
-											step->newrow = row - 2;
-											step->attack = 1;
-											step->attackcol = col + 1;
-											step->attackrow = row - 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row - 1 >= 0) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col + 1;
-									step->newrow = row - 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
+		checkers.block[(row)* checkers.event.cells_per_row + col]->turn = checkers.block[(row1)* checkers.event.cells_per_row + col1]->turn;
+		checkers.block[(row1)* checkers.event.cells_per_row + col1]->turn = EMPTY;
 
-							if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-								if (checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row - 2 >= 0 && col - 2 >= 0) { //doesn't go out of bounds
-										if (checkers.block[(row - 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 2;
-											step->newrow = row - 2;
-											step->attack = 1;
-											step->attackcol = col - 1;
-											step->attackrow = row - 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row - 1 >= 0) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col - 1;
-									step->newrow = row - 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
-						}
-					} else { //if not king
-						if (col == 7 || col == 0) { //if on edge
-							if (col == 0) { //can move right only
-								if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-									if (checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row + 2 <= 7 && col + 2 <= 7) { //doesn't go out of bounds
-											if (checkers.block[(row + 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col + 2;
-												step->newrow = row + 2;
-												step->attack = 1;
-												step->attackcol = col + 1;
-												step->attackrow = row + 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row + 1 <= 7) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col + 1;
-										step->newrow = row + 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							} else if (col == 7) { //can move left only
-								if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-									if (checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row + 2 <= 7 && col - 2 >= 0) { //doesn't go out of bounds
-											if (checkers.block[(row + 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col - 2;
-												step->newrow = row + 2;
-												step->attack = 1;
-												step->attackcol = col - 1;
-												step->attackrow = row + 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row + 1 <= 7) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col - 1;
-										step->newrow = row + 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							}
-						} else { //if not on edge
-							if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-								if (checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row + 2 <= 7 && col + 2 <= 7) { //doesn't go out of bounds
-										if (checkers.block[(row + 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 2;
-											step->newrow = row + 2;
-											step->attack = 1;
-											step->attackcol = col + 1;
-											step->attackrow = row + 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row + 1 <= 7) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col + 1;
-									step->newrow = row + 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
+		checkers.block[(row1)* checkers.event.cells_per_row + col1]->stone = nullptr;
+	}
 
-							if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-								if (checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row + 2 <= 7 && col - 2 >= 0) { //doesn't go out of bounds
-										if (checkers.block[(row + 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 2;
-											step->newrow = row + 2;
-											step->attack = 1;
-											step->attackcol = col - 1;
-											step->attackrow = row + 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row + 1 <= 7) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col - 1;
-									step->newrow = row + 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
-						}
-					}
-				}
-			}
-		}
-	} else if (turn == PLAYER) {
-		for (int row = 0; row < 8; row++) {
-			for (int col = 0; col < 8; col++) {
-				if (checkers.block[row * checkers.event.cells_per_row + col]->turn == PLAYER) {
-					if (checkers.block[row * checkers.event.cells_per_row + col]->stone != NULL && checkers.block[row * checkers.event.cells_per_row + col]->stone->state == STONE_KING) { //if king
-						if (col == 7 || col == 0 || row == 0 || row == 7) { //if on edge
-							if (col == 0 && row == 0) { // can move right down only
-								if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-									if (checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row + 2 <= 7 && col + 2 <= 7) { //doesn't go out of bounds
-											if (checkers.block[(row + 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col + 2;
-												step->newrow = row + 2;
-												step->attack = 1;
-												step->attackcol = col + 1;
-												step->attackrow = row + 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row + 1 <= 7) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col + 1;
-										step->newrow = row + 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							} else if (col == 0 && row == 7) { //can move right up only
-								if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-									if (checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row - 2 >= 0 && col + 2 <= 7) { //doesn't go out of bounds
-											if (checkers.block[(row - 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col + 2;
-												step->newrow = row - 2;
-												step->attack = 1;
-												step->attackcol = col + 1;
-												step->attackrow = row - 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row - 1 >= 0) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col + 1;
-										step->newrow = row - 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							} else if (col == 7 && row == 0) { //can move left up only
-								if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-									if (checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row + 2 <= 7 && col - 2 >= 0) { //doesn't go out of bounds
-											if (checkers.block[(row + 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col - 2;
-												step->newrow = row + 2;
-												step->attack = 1;
-												step->attackcol = col - 1;
-												step->attackrow = row + 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row + 1 <= 7) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col - 1;
-										step->newrow = row + 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							} else if (col == 7 && row == 7) { //can move left down only
-								if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-									if (checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row - 2 >= 0 && col - 2 >= 0) { //doesn't go out of bounds
-											if (checkers.block[(row - 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col - 2;
-												step->newrow = row - 2;
-												step->attack = 1;
-												step->attackcol = col - 1;
-												step->attackrow = row - 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row - 1 >= 0) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col - 1;
-										step->newrow = row - 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							} else {
-								if (col == 0) { //can move right only
-									if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-										if (checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row + 2 <= 7 && col + 2 <= 7) { //doesn't go out of bounds
-												if (checkers.block[(row + 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col + 2;
-													step->newrow = row + 2;
-													step->attack = 1;
-													step->attackcol = col + 1;
-													step->attackrow = row + 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row + 1 <= 7) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 1;
-											step->newrow = row + 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-									if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-										if (checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row - 2 >= 0 && col + 2 <= 7) { //doesn't go out of bounds
-												if (checkers.block[(row - 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col + 2;
-													step->newrow = row - 2;
-													step->attack = 1;
-													step->attackcol = col + 1;
-													step->attackrow = row - 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row - 1 >= 0) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 1;
-											step->newrow = row - 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								} else if (col == 7) { //can move left only
-									if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-										if (checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row + 2 <= 7 && col - 2 >= 0) { //doesn't go out of bounds
-												if (checkers.block[(row + 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col - 2;
-													step->newrow = row + 2;
-													step->attack = 1;
-													step->attackcol = col - 1;
-													step->attackrow = row + 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row + 1 <= 7) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 1;
-											step->newrow = row + 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-									if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-										if (checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row - 2 >= 0 && col - 2 >= 0) { //doesn't go out of bounds
-												if (checkers.block[(row - 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col - 2;
-													step->newrow = row - 2;
-													step->attack = 1;
-													step->attackcol = col - 1;
-													step->attackrow = row - 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row - 1 >= 0) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 1;
-											step->newrow = row - 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								} else if (row == 0) { // can move down only
-									if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-										if (checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row + 2 <= 7 && col - 2 >= 0) { //doesn't go out of bounds
-												if (checkers.block[(row + 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col - 2;
-													step->newrow = row + 2;
-													step->attack = 1;
-													step->attackcol = col - 1;
-													step->attackrow = row + 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row + 1 <= 7) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 1;
-											step->newrow = row + 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-									if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-										if (checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row + 2 <= 7 && col + 2 <= 7) { //doesn't go out of bounds
-												if (checkers.block[(row + 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col + 2;
-													step->newrow = row + 2;
-													step->attack = 1;
-													step->attackcol = col + 1;
-													step->attackrow = row + 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row + 1 <= 7) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 1;
-											step->newrow = row + 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								} else if (row == 7) { //can move up only
-									if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-										if (checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row - 2 >= 0 && col - 2 >= 0) { //doesn't go out of bounds
-												if (checkers.block[(row - 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col - 2;
-													step->newrow = row - 2;
-													step->attack = 1;
-													step->attackcol = col - 1;
-													step->attackrow = row - 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row - 1 >= 0) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 1;
-											step->newrow = row - 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-									if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-										if (checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-											if (row - 2 >= 0 && col + 2 <= 7) { //doesn't go out of bounds
-												if (checkers.block[(row - 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-													Step *step = (Step*)malloc(sizeof(Step));
-													step->oldcol = col;
-													step->oldrow = row;
-													step->newcol = col + 2;
-													step->newrow = row - 2;
-													step->attack = 1;
-													step->attackcol = col + 1;
-													step->attackrow = row - 1;
-													step->next = NULL;
-													current->next = step;
-													current = current->next;
-												}
-											}
-										}
-									} else { //if not blocked
-										if (row + 1 <= 7) { //doesn't go out of bounds
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 1;
-											step->newrow = row - 1;
-											step->attack = 0;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							}
-						} else { //if not on edge
-							if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-								if (checkers.block[(row + 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row + 2 <= 7 && col + 2 <= 7) { //doesn't go out of bounds
-										if (checkers.block[(row + 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 2;
-											step->newrow = row + 2;
-											step->attack = 1;
-											step->attackcol = col + 1;
-											step->attackrow = row + 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row + 1 <= 7) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col + 1;
-									step->newrow = row + 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
+	checkers.block[(row)* checkers.event.cells_per_row + col]->stone->isAnimating = true;
+	checkers.block[(row)* checkers.event.cells_per_row + col]->stone->animx = checkers.block[(row)* checkers.event.cells_per_row + col]->x + checkers.stones_length;
+	checkers.block[(row)* checkers.event.cells_per_row + col]->stone->animy = checkers.block[(row)* checkers.event.cells_per_row + col]->y + checkers.stones_height;
+	checkers.block[(row)* checkers.event.cells_per_row + col]->stone->animz = checkers.block[(row)* checkers.event.cells_per_row + col]->z + checkers.stones_width;
 
-							if (!checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-								if (checkers.block[(row + 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row + 2 <= 7 && col - 2 >= 0) { //doesn't go out of bounds
-										if (checkers.block[(row + 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 2;
-											step->newrow = row + 2;
-											step->attack = 1;
-											step->attackcol = col - 1;
-											step->attackrow = row + 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row + 1 <= 7) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col - 1;
-									step->newrow = row + 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
+	for (auto& i : checkers.block) {
+		if (i->isSelected)
+			i->isSelected = false;
+		if (i->state != BLOCK_IDLE)
+			i->state = BLOCK_IDLE;
+	}
 
-							if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-								if (checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row - 2 >= 0 && col + 2 <= 7) { //doesn't go out of bounds
-										if (checkers.block[(row - 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 2;
-											step->newrow = row - 2;
-											step->attack = 1;
-											step->attackcol = col + 1;
-											step->attackrow = row - 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row - 1 >= 0) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col + 1;
-									step->newrow = row - 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
+	checkers.event.turn = checkers.event.turn == PLAYER ? COMPUTER : PLAYER;
 
-							if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-								if (checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row - 2 >= 0 && col - 2 >= 0) { //doesn't go out of bounds
-										if (checkers.block[(row - 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 2;
-											step->newrow = row - 2;
-											step->attack = 1;
-											step->attackcol = col - 1;
-											step->attackrow = row - 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row - 1 >= 0) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col - 1;
-									step->newrow = row - 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
-						}
-					} else { //if not king
-						if (col == 7 || col == 0) { //if on edge
-							if (col == 0) { //can move right only
-								if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-									if (checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row - 2 >= 0 && col + 2 <= 7) { //doesn't go out of bounds
-											if (checkers.block[(row - 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col + 2;
-												step->newrow = row - 2;
-												step->attack = 1;
-												step->attackcol = col + 1;
-												step->attackrow = row - 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row - 1 >= 0) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col + 1;
-										step->newrow = row - 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							} else if (col == 7) { //can move left only
-								if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-									if (checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-										if (row - 2 >= 0 && col - 2 >= 0) { //doesn't go out of bounds
-											if (checkers.block[(row - 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-												Step *step = (Step*)malloc(sizeof(Step));
-												step->oldcol = col;
-												step->oldrow = row;
-												step->newcol = col - 2;
-												step->newrow = row - 2;
-												step->attack = 1;
-												step->attackcol = col - 1;
-												step->attackrow = row - 1;
-												step->next = NULL;
-												current->next = step;
-												current = current->next;
-											}
-										}
-									}
-								} else { //if not blocked
-									if (row - 1 >= 0) { //doesn't go out of bounds
-										Step *step = (Step*)malloc(sizeof(Step));
-										step->oldcol = col;
-										step->oldrow = row;
-										step->newcol = col - 1;
-										step->newrow = row - 1;
-										step->attack = 0;
-										step->next = NULL;
-										current->next = step;
-										current = current->next;
-									}
-								}
-							}
-						} else { //if not on edge
-							if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->isEmpty) { //if blocked
-								if (checkers.block[(row - 1) * checkers.event.cells_per_row + col + 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row - 2 >= 0 && col + 2 <= 7) { //doesn't go out of bounds
-										if (checkers.block[(row - 2) * checkers.event.cells_per_row + col + 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col + 2;
-											step->newrow = row - 2;
-											step->attack = 1;
-											step->attackcol = col + 1;
-											step->attackrow = row - 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row - 1 >= 0) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col + 1;
-									step->newrow = row - 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
+	if (row == 0)
+		checkers.block[(row)* checkers.event.cells_per_row + col]->stone->state = STONE_KING;
 
-							if (!checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->isEmpty) { //if blocked
-								if (checkers.block[(row - 1) * checkers.event.cells_per_row + col - 1]->turn != checkers.block[row * checkers.event.cells_per_row + col]->turn) { //if not same type
-									if (row - 2 >= 0 && col - 2 >= 0) { //doesn't go out of bounds
-										if (checkers.block[(row - 2) * checkers.event.cells_per_row + col - 2]->isEmpty) {//if the one after it is not occupied
-											Step *step = (Step*)malloc(sizeof(Step));
-											step->oldcol = col;
-											step->oldrow = row;
-											step->newcol = col - 2;
-											step->newrow = row - 2;
-											step->attack = 1;
-											step->attackcol = col - 1;
-											step->attackrow = row - 1;
-											step->next = NULL;
-											current->next = step;
-											current = current->next;
-										}
-									}
-								}
-							} else { //if not blocked
-								if (row - 1 >= 0) { //doesn't go out of bounds
-									Step *step = (Step*)malloc(sizeof(Step));
-									step->oldcol = col;
-									step->oldrow = row;
-									step->newcol = col - 1;
-									step->newrow = row - 1;
-									step->attack = 0;
-									step->next = NULL;
-									current->next = step;
-									current = current->next;
-								}
-							}
-						}
-					}
-				}
+	if (checkers.event.difficulty == MULTIPLAYER) {
+		// the server takes a capture hop by hop, the turn stays with the PLAYER until the last hop
+		for (int hop = 0; hop < hops; hop++) {
+			const int oldsquare = hop > 0 ? path[hop - 1] : move.from;
+			int soldcol = squareCol(oldsquare),
+				soldrow = squareRow(oldsquare),
+				scol = squareCol(path[hop]),
+				srow = squareRow(path[hop]),
+				sattack = 0,
+				sattackrow = 0,
+				sattackcol = 0;
+			if (move.attack) {
+				sattack = 1;
+				sattackrow = (soldrow + srow) / 2;
+				sattackcol = (soldcol + scol) / 2;
 			}
+			char *buffer = (char*)malloc(sizeof(char) * 20);
+			sprintf(buffer, "#%d,%d,%d,%d,%d,%d,%d,%d.", hop < hops - 1 ? PLAYER : checkers.event.turn, soldcol, soldrow, scol, srow, sattack, sattackcol, sattackrow);
+			sendToServer(buffer);
 		}
+		if (checkers.event.turn != PLAYER)
+			checkers.MPSTATUS = MP_WAITING;
 	}
-
-	root = root->next; // Skip the initial dummy node
-	return root; // Return the generated moves
-
 }
 
+/*
+ * Captures of the selected stone can end on the same square with different stones jumped. The click on that
+ * square then only picks the end: the player clicks the landing squares of the hops where they part,
+ * one after the other, until a single capture is left.
+ */
+static int clickTarget = -1; // square the captures being told apart end on, -1 when the player did not click one yet
+static unsigned char clickPath[MAX_JUMPS]; // landing squares of the hops the player chose so far
+static int clickHops = 0;
+
 /**
- * Frees the memory allocated for a linked list of moves.
- * @param step - The linked list of moves to release.
+ * Forgets the landing squares the player chose, when a stone is selected or a move played.
  */
-void releaseStep(Step * step)
-{
-	while (step) {
-		Step *oldStep = step;
-		step = step->next;
-		free(oldStep);
-	}
+static void resetClickPath() {
+	clickTarget = -1;
+	clickHops = 0;
 }
 
 /**
- * Filters a list of moves to include only attack moves.
- * @param moves - The linked list of moves to filter.
- * @return A linked list of attack moves.
+ * Collects the legal moves of the selected stone that end on the target square and go through the landing squares chosen so far.
+ * The target may be the stone's own square, for a king's capture coming back to it.
+ * @param position - The position on the board, PLAYER to move.
+ * @param from - Square of the selected stone.
+ * @param to - Square the moves end on.
+ * @param candidates - Receives the moves, at least MAX_MOVES of them.
+ * @param paths - Receives the landing squares of each move, from movePath.
+ * @return The number of moves.
  */
-Step *filterAttackMoves(Step *moves) {
-	Step * temp = moves;
-	if (!isThereAttackMoves(temp))
-		return NULL;
-	Step* root = (Step*)malloc(sizeof(Step));
-	Step* current = root;
-	while (temp) {
-		if (temp->attack) {
-			Step *move = (Step*)malloc(sizeof(Step));
-			move->attack = temp->attack;
-			move->attackcol = temp->attackcol;
-			move->attackrow = temp->attackrow;
-			move->oldcol = temp->oldcol;
-			move->oldrow = temp->oldrow;
-			move->newcol = temp->newcol;
-			move->newrow = temp->newrow;
-			move->next = NULL;
-
-			current->next = move;
-			current = current->next;
-		}
-		temp = temp->next;
+static int clickCandidates(const S_Position &position, int from, int to, S_Move *candidates, unsigned char (*paths)[MAX_JUMPS]) {
+	S_MoveList moves;
+	generateMoves(position, PLAYER, moves);
+	if (isThereAttackMoves(moves))
+		filterAttackMoves(moves);
+	int count = 0;
+	for (int i = 0; i < moves.count; i++) {
+		if (moves.moves[i].from != from || moves.moves[i].to != to)
+			continue;
+		bool listed = false; // a king going round one way or the other is the same capture
+		for (int j = 0; j < count; j++)
+			listed = listed || candidates[j].captured == moves.moves[i].captured;
+		if (listed)
+			continue;
+		const int hops = movePath(position, moves.moves[i], paths[count]);
+		if (hops < clickHops || memcmp(paths[count], clickPath, clickHops) != 0)
+			continue;
+		candidates[count++] = moves.moves[i];
 	}
-	root = root->next; // Skip the initial dummy node
-	return root; // Return the filtered moves
+	return count;
 }
 
 /**
- * Checks if there are any attack moves in a list of moves.
- * @param moves - The linked list of moves to check.
- * @return 1 if there are attack moves, 0 otherwise.
+ * Plays the move of the selected stone the player picked with a click, or shows where the captures ending there part.
+ * @param checkers - The current state of the checkers game, PLAYER to move.
+ * @param from - Square of the selected stone.
+ * @param clicked - The clicked square: where the move ends, or the next landing square of the captures ending on clickTarget.
+ *                  It may be the square of the selected stone, a king's capture can come back to it or go through it.
+ * @return false when no legal move matches the click, nothing changed then.
  */
-int isThereAttackMoves(Step *moves) {
-	Step * temp = moves;
-	while (temp) {
-		if (temp->attack)
-			return 1;
-		temp = temp->next;
+static bool clickMove(Checkers &checkers, int from, int clicked) {
+	int target = clicked;
+	if (clickTarget >= 0) {
+		clickPath[clickHops++] = (unsigned char)clicked;
+		target = clickTarget;
+	}
+	const S_Position position = positionFromCheckers(checkers, PLAYER);
+	S_Move candidates[MAX_MOVES];
+	unsigned char paths[MAX_MOVES][MAX_JUMPS];
+	const int count = clickCandidates(position, from, target, candidates, paths);
+	if (count == 0) {
+		if (clickTarget >= 0)
+			clickHops--;
+		return false;
 	}
-	return 0;
+	if (count == 1) {
+		resetClickPath();
+		movePlayerStone(checkers, candidates[0]);
+		return true;
+	}
+
+	// several captures end there: skip the hops they share, show where they part
+	// (they part before the shortest ends, a capture can not stop where another goes on)
+	int hop = clickHops;
+	while (hop < MAX_JUMPS - 1) {
+		int same = 1;
+		while (same < count && paths[same][hop] == paths[0][hop])
+			same++;
+		if (same < count)
+			break;
+		clickPath[hop] = paths[0][hop];
+		hop++;
+	}
+	clickHops = hop;
+	clickTarget = target;
+	for (auto& i : checkers.block)
+		if (i->state == BLOCK_OPTIONAL_PATH)
+			i->state = BLOCK_IDLE;
+	for (int i = 0; i < count; i++)
+		checkers.block[squareRow(paths[i][hop]) * checkers.event.cells_per_row + squareCol(paths[i][hop])]->state = BLOCK_OPTIONAL_PATH;
+	printf("%d captures end there, click the square to jump to next\n", count);
+	return true;
 }
 
 /**
@@ -1610,6 +457,14 @@ int isThereAttackMoves(Step *moves) {
  */
 void applyClick(Checkers &checkers, const int & col, const int & row)
 {
+	if (checkers.event.turn != PLAYER)
+		return; // the window keeps taking clicks while the computer is thinking
+
+	// the selected stone's own square is a move when a king's capture comes back to it or its next hop lands there
+	if (checkers.stone_selected && checkers.block[row * checkers.event.cells_per_row + col]->isSelected
+		&& clickMove(checkers, squareIndex(row, col), squareIndex(row, col)))
+		return;
+
 	if (!checkers.block[row * checkers.event.cells_per_row + col]->isEmpty && checkers.block[row * checkers.event.cells_per_row + col]->turn == PLAYER) {
 		// Handle the selection of a stone
 		
@@ -1627,20 +482,18 @@ void applyClick(Checkers &checkers, const int & col, const int & row)
 			checkers.block[row * checkers.event.cells_per_row + col]->state = BLOCK_SELECTED;
 			checkers.stone_selected = true;
 		}
-
-		Step *stepRoot = generateMoves(checkers, PLAYER);
-		Step *step = stepRoot;
-		if (isThereAttackMoves(step))
-			step = filterAttackMoves(step);
-		//printf("\n");
-		while (step) {
-			//printf("POSSIBLE MOVE: oldcol: %d - oldow: %d | newcol: %d - newrow: %d | attack = %d\n", step->oldcol, step->oldrow, step->newcol, step->newrow, step->attack);
-			if (step->oldcol == col && step->oldrow == row) {
-				checkers.block[step->newrow * checkers.event.cells_per_row + step->newcol]->state = BLOCK_OPTIONAL_PATH;
+		resetClickPath();
+
+		S_MoveList moves;
+		generateMoves(checkers, PLAYER, moves);
+		if (isThereAttackMoves(moves))
+			filterAttackMoves(moves);
+		for (int i = 0; i < moves.count; i++) {
+			//printf("POSSIBLE MOVE: from: %d | to: %d | attack = %d\n", moves.moves[i].from, moves.moves[i].to, moves.moves[i].attack);
+			if (moves.moves[i].from == squareIndex(row, col)) {
+				checkers.block[squareRow(moves.moves[i].to) * checkers.event.cells_per_row + squareCol(moves.moves[i].to)]->state = BLOCK_OPTIONAL_PATH;
 			}
-			step = step->next;
 		}
-		releaseStep(stepRoot);
 
 	} else {
 		// Handle the movement of a selected stone
@@ -1650,105 +503,9 @@ void applyClick(Checkers &checkers, const int & col, const int & row)
 				for (int row1 = 0; row1 < checkers.event.cells_per_row; row1++) {
 					for (int col1 = 0; col1 < checkers.event.cells_per_row; col1++) {
 						if (checkers.block[(row1)* checkers.event.cells_per_row + col1]->isSelected) {
-							Step *stepRoot = generateMoves(checkers, PLAYER); //released
-							Step *step = stepRoot;
-							if (isThereAttackMoves(step)) {
-								Step *temp = step;
-								int flag = 0;
-								while (temp) {
-									if (temp->newcol == col && temp->newrow == row && temp->attack) {
-										flag = 1;
-										break;
-									}
-									temp = temp->next;
-								}
-								if (flag) {
-									step = filterAttackMoves(step);
-									while (step) {
-										if (step->newcol == col && step->newrow == row) {
-											checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->stone->y = checkers.event.y - 1;
-											checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->turn = EMPTY;
-											checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->isEmpty = true;
-											checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->stone = nullptr;
-											break;
-										}
-										step = step->next;
-									}
-									releaseStep(stepRoot);
-								}
-							}
-
-							int soldcol = col1,
-								soldrow = row1,
-								scol = col,
-								srow = row,
-								sattack = 0,
-								sattackrow = 0,
-								sattackcol = 0;
-							if (step->attack) {
-								sattack = step->attack;
-								sattackrow = step->attackrow;
-								sattackcol = step->attackcol;
-							}
-
-							checkers.block[(row)* checkers.event.cells_per_row + col]->stone = checkers.block[(row1)* checkers.event.cells_per_row + col1]->stone;
-
-							checkers.block[(row)* checkers.event.cells_per_row + col]->stone->isAnimating = true;
-							checkers.block[(row)* checkers.event.cells_per_row + col]->stone->animx = checkers.block[(row)* checkers.event.cells_per_row + col]->x + checkers.stones_length;
-							checkers.block[(row)* checkers.event.cells_per_row + col]->stone->animy = checkers.block[(row)* checkers.event.cells_per_row + col]->y + checkers.stones_height;
-							checkers.block[(row)* checkers.event.cells_per_row + col]->stone->animz = checkers.block[(row)* checkers.event.cells_per_row + col]->z + checkers.stones_width;
-
-							checkers.block[(row)* checkers.event.cells_per_row + col]->isEmpty = checkers.block[(row1)* checkers.event.cells_per_row + col1]->isEmpty;
-							checkers.block[(row1)* checkers.event.cells_per_row + col1]->isEmpty = true;;
-
-							checkers.block[(row)* checkers.event.cells_per_row + col]->turn = checkers.block[(row1)* checkers.event.cells_per_row + col1]->turn;
-							checkers.block[(row1)* checkers.event.cells_per_row + col1]->turn = EMPTY;
-
-							checkers.block[(row1)* checkers.event.cells_per_row + col1]->stone = nullptr;
-
-
-							for (auto& i : checkers.block) {
-								if (i->isSelected)
-									i->isSelected = false;
-								if (i->state != BLOCK_IDLE)
-									i->state = BLOCK_IDLE;
-							}
-
-							checkers.event.turn = checkers.event.turn == PLAYER ? COMPUTER : PLAYER;
-							
-							if (row == 0)
-								checkers.block[(row)* checkers.event.cells_per_row + col]->stone->state = STONE_KING;
-
-
-							if (step->attack) {
-								Step *stepRoot = generateMoves(checkers, PLAYER); //released
-								Step *step1 = stepRoot;
-								if (isThereAttackMoves(step1)) {
-									step1 = filterAttackMoves(step1);
-									while (step1) {
-										if (step1->oldcol == step->newcol && step1->oldrow == step->newrow) {
-											checkers.event.turn = PLAYER;
-											if (checkers.event.difficulty != MULTIPLAYER) {
-												checkers.block[step->newrow * checkers.event.cells_per_row + step->newcol]->isSelected = true;
-												checkers.block[step->newrow * checkers.event.cells_per_row + step->newcol]->state = BLOCK_SELECTED;
-												checkers.stone_selected = true;
-												checkers.block[step1->newrow * checkers.event.cells_per_row + step1->newcol]->state = BLOCK_OPTIONAL_PATH;
-											}
-										}
-										step1 = step1->next;
-									}
-								}
-								releaseStep(stepRoot);
-							}
-							if (checkers.event.difficulty == MULTIPLAYER) {
-								char *buffer = (char*)malloc(sizeof(char) * 20);
-								sprintf(buffer, "#%d,%d,%d,%d,%d,%d,%d,%d.", checkers.event.turn, soldcol, soldrow, scol, srow, sattack, sattackcol, sattackrow);
-								sendToServer(buffer);
-								if (checkers.event.turn != PLAYER)
-									checkers.MPSTATUS = MP_WAITING;
-							}
-							break;
-
+							if (!clickMove(checkers, squareIndex(row1, col1), squareIndex(row, col)))
+								resetClickPath();
+							return;
 						}
 					}
 				}
@@ -1760,8 +517,9 @@ void applyClick(Checkers &checkers, const int & col, const int & row)
 /**
  * Applies the best move for the computer.
  * @param checkers - The current state of the checkers game.
+ * @return true when the step was applied, false when the HARD or MCTS search is still running.
  */
-void applyComputerStep(Checkers & checkers)
+bool applyComputerStep(Checkers & checkers)
 {
 	if (checkers.event.difficulty == MULTIPLAYER) {
 		//send request to server asking for step details
@@ -1818,112 +576,25 @@ void applyComputerStep(Checkers & checkers)
 		}
 
 	} 
-	else if (checkers.event.difficulty == HARD) {
-		Step *step = getBestMove(checkers, COMPUTER);
-
-		checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone = checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->stone;
-
-		checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone->isAnimating = true;
-		checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone->animx = checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->x + checkers.stones_length;
-		checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone->animy = checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->y + checkers.stones_height;
-		checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone->animz = checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->z + checkers.stones_width;
-
-		checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->isEmpty = checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->isEmpty;
-		checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->isEmpty = true;;
-
-		checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->turn = checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->turn;
-		checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->turn = EMPTY;
-
-		checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->stone = nullptr;
-
-		checkers.event.turn = PLAYER;
-
-		if (step->newrow == 7)
-			checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone->state = STONE_KING;
-
-		if (step->attack) {
-			checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->stone->y = checkers.event.y - 1;
-			checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->turn = EMPTY;
-			checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->isEmpty = true;
-			checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->stone = nullptr;
-			int newrow = step->newrow;
-			int newcol = step->newcol;
-			Step *stepRoot1 = generateMoves(checkers, COMPUTER);
-			Step *step1 = stepRoot1; //released
-			while (step1) {
-				if (step1->attack) {
-					if (step1->oldrow == newrow && step1->oldcol == newcol) {
-						checkers.event.turn = COMPUTER;
-						break;
-					}
-				}
-				step1 = step1->next;
-			}
-			releaseStep(stepRoot1);
-		}
+	else if (checkers.event.difficulty == HARD || checkers.event.difficulty == MCTS) {
+		S_SearchResult result;
+		if (!getBestMove(checkers, result))
+			return false; // still searching, polled again on the next frame
+		if (result.pvLength == 0)
+			return true; // no legal moves, check_result ends the game
+		moveComputerStone(checkers, result.move);
+		if (checkers.event.difficulty == HARD)
+			startPonderSearch(checkers, result);
 	} else {
-		Step *stepRoot = generateMoves(checkers, COMPUTER);
-		Step *step = stepRoot; //released
-		if (isThereAttackMoves(step))
-			step = filterAttackMoves(step);
-		int stepCount = 0;
-		while (step) {
-			stepCount++;
-			step = step->next;
-		}
-		step = stepRoot;
-		if (isThereAttackMoves(step))
-			step = filterAttackMoves(step);
+		S_MoveList moves;
+		generateMoves(checkers, COMPUTER, moves);
+		if (isThereAttackMoves(moves))
+			filterAttackMoves(moves);
 		//randomize step
-		int random = rand() % stepCount;
-		for (int i = 0; i < random; i++)
-			step = step->next;
-
-		while (step) {
-			checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone = checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->stone;
-
-			checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone->isAnimating = true;
-			checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone->animx = checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->x + checkers.stones_length;
-			checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone->animy = checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->y + checkers.stones_height;
-			checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone->animz = checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->z + checkers.stones_width;
-
-			checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->isEmpty = checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->isEmpty;
-			checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->isEmpty = true;;
-
-			checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->turn = checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->turn;
-			checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->turn = EMPTY;
-
-			checkers.block[(step->oldrow)* checkers.event.cells_per_row + step->oldcol]->stone = nullptr;
-
-			checkers.event.turn = PLAYER;
-
-			if (step->newrow == 7)
-				checkers.block[(step->newrow)* checkers.event.cells_per_row + step->newcol]->stone->state = STONE_KING;
-
-			if (step->attack) {
-				checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->stone->y = checkers.event.y - 1;
-				checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->turn = EMPTY;
-				checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->isEmpty = true;
-				checkers.block[(step->attackrow) * checkers.event.cells_per_row + step->attackcol]->stone = nullptr;
-
-				Step *stepRoot1 = generateMoves(checkers, COMPUTER);
-				Step *step1 = stepRoot1; //released
-				while (step1) {
-					if (step1->attack) {
-						if (step1->oldrow == step->newrow && step1->oldcol == step->newcol) {
-							checkers.event.turn = COMPUTER;
-							break;
-						}
-					}
-					step1 = step1->next;
-				}
-				releaseStep(stepRoot1);
-			}
-
-			break;
-		}
-		releaseStep(stepRoot);
+		if (moves.count)
+			moveComputerStone(checkers, moves.moves[rand() % moves.count]);
 	}
+	return true;
 }
 
 /**
@@ -1934,26 +605,11 @@ void check_result(Checkers& checkers)
 {
 	if (checkers.result != RESULT_NOTYET)
 		return;
-	bool isThereWhiteSteps = false, isThereBlackSteps = false;
-	Step *stepRoot = generateMoves(checkers, WHITE);
-	Step* whiteMoves = stepRoot;
-	if (whiteMoves)
-		isThereWhiteSteps = true;
-	if (!isThereWhiteSteps)
-	{
+	const E_MoveTurn loser = sideWithoutMoves(positionFromCheckers(checkers, PLAYER));
+	if (loser == PLAYER)
 		checkers.result = RESULT_LOST;
-		return;
-	}
-	Step *stepRoot1 = generateMoves(checkers, BLACK);
-	Step* blackMoves = stepRoot1;
-	if (blackMoves)
-		isThereBlackSteps = true;
-	if (!isThereBlackSteps)
-	{
+	else if (loser == COMPUTER)
 		checkers.result = RESULT_WON;
-	}
-	releaseStep(stepRoot);
-	releaseStep(stepRoot1);
 }
 
 /**
@@ -8,42 +8,27 @@
 /* ========================================================================== */
 #pragma once
 #include <stdlib.h> // for random in easy mode
-#include "../multiplayer/multiplayer.h"
 #include "checkers.h"
+#include "../engine/Search.h"
+#include "../engine/Book.h"
 
+#define COMPUTER_MOVE_MS 200 /* time the computer thinks about a move in HARD and MCTS mode */
+#define COMPUTER_THREADS 0 /* threads searching the computer's move in HARD and MCTS mode, 0 for one per core */
+#define COMPUTER_MCTS_PLAYOUTS 0 /* playouts of a move in MCTS mode, 0 to only use COMPUTER_MOVE_MS */
+#define TABLEBASE_FILE "checkers.tb" /* endgame tablebase written by tools/tbgen, HARD searches without one when it is missing */
+#define BOOK_FILE "checkers.book" /* opening book written by tools/bookgen, HARD searches every move without one */
+#define NETWORK_FILE "checkers.nn" /* evaluation network written by tools/nntrain, HARD evaluates with evaluateBoard without one */
 
-typedef struct step { /* step struct used for calculating and manipulating steps while the game is running */
-	step(step *copy) {
-		oldcol = copy->oldcol;
-		oldrow = copy->oldrow;
-		newcol = copy->newcol;
-		newrow = copy->newrow;
-		attack = copy->attack;
-		attackcol = copy->attackcol;
-		attackrow = copy->attackrow;
-		next = NULL;
-	}
-	int oldcol;
-	int oldrow;
-	int newcol;
-	int newrow;
-	int attack;
-	int attackcol;
-	int attackrow;
-	struct step *next; /* for NODE data structure use */
-}Step;
-
-Step *generateMoves(Checkers &checkers, int turn);
-void releaseStep(Step* step);
-Step *filterAttackMoves(Step *moves);
-int isThereAttackMoves(Step *moves);
+void generateMoves(Checkers &checkers, int turn, S_MoveList &moves);
+S_Position positionFromCheckers(const Checkers &checkers, int turn);
 void applyClick(Checkers &checkers, const int &col, const int &row);
-void applyComputerStep(Checkers &checkers);
+bool applyComputerStep(Checkers &checkers);
 void check_result(Checkers& checkers);
 GLfloat difference(const GLfloat& x, const GLfloat& y);
 
 //MINMAX
-int miniMax(Checkers checkers, int depth, int turn);
-Checkers applyMove(Checkers checkers, Step *step);
-int evaluateBoard(Checkers &checkers);
-Step *getBestMove(Checkers checkers, int turn);
\ No newline at end of file
+extern S_SearchOptions computerSearchOptions;
+extern bool computerPondering;
+extern bool computerNetwork;
+void startComputerSearch(Checkers &checkers);
+bool getBestMove(Checkers &checkers, S_SearchResult &result);
\ No newline at end of file
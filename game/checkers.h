@@ -10,6 +10,8 @@
 /* ========================================================================== */
 #pragma once
 #include "../graphics/renderer.h"
+#include "../engine/Position.h" // E_MoveTurn and the bitboard position used by the computer
+#include "../engine/SearchJob.h" // the computer's search running in the background
 
 typedef enum { WHITE, BLACK } E_CellType; /* this enum is characterizes the checkers part (block or stone)  */
 
@@ -26,18 +28,12 @@ typedef enum
 	MP_PLAYING
 }E_MultiplayerStatus;
 
-typedef enum
-{
-    EMPTY = -1, // used when checkers class is created, and no changes yet occured
-    PLAYER = 0,
-    COMPUTER = 1
-} E_MoveTurn; /* tells who can make action in the game, when game is started */
-
 typedef enum
 {
     EASY = 0, // randomize computer movements
     HARD = 1,  // minimax algorithm computer movements
-	MULTIPLAYER = 2
+	MULTIPLAYER = 2,
+	MCTS = 3 // Monte Carlo tree search computer movements
 } E_Difficulty; /* for setting computer's algorithm of taking actions in the game */
 
 struct S_BoardEvent
@@ -122,7 +118,7 @@ struct S_CheckersStone /* struct used for creating and manipulating stone in che
             color = GLvec3Color(0.22f, 0.09f, 0.09f);
     }
 	S_CheckersStone(S_CheckersStone *copy) {
-		this->type = type;
+		this->type = copy != nullptr ? copy->type : WHITE;
 		if (type == WHITE)
 			color = GLvec3Color(0.83, 0.8, 0.71);
 		else if (type == BLACK)
@@ -175,8 +171,8 @@ struct S_CheckersBlock
             color = GLvec3Color(1.0f, 1.0f, 1.0f);
         stone = nullptr;
     }
-	S_CheckersBlock(S_CheckersBlock *copy) { //copy->constructor
-		this->type = type;
+	S_CheckersBlock(S_CheckersBlock *copy) { //copy->constructor, the stone pointer is left for the owner to relink
+		this->type = copy->type;
 		if (type == BLACK)
 			color = GLvec3Color(0.0f, 0.0f, 0.0f);
 		else if (type == WHITE)
@@ -192,7 +188,6 @@ struct S_CheckersBlock
 		type = copy->type;
 		turn = copy->turn;
 		color = copy->color;
-		stone = new S_CheckersStone(copy->stone);
 		state = copy->state;
 		isEmpty = copy->isEmpty;
 		isSelected = copy->isSelected;
@@ -251,6 +246,7 @@ public:
     bool stone_selected;
     bool isAnimating;
 	int doneAnimatingCam;
+	S_SearchJob search; // computer's search in HARD and MCTS mode, cancelled when the game stops or resets
 
     S_CheckersBlock *block[BLOCK_CELLS];
     S_CheckersStone *black[STONES_COUNT];
@@ -14,6 +14,7 @@
 //#include <stdlib.h> // for random in easy mode
 //#include "graphics/renderer.h" // header for loading and drawing envrionment and table in openGL world
 //#include "game/checkers.h" // header for loading checkers(draught) game class, structs, and global functions
+#include "multiplayer/multiplayer.h" // first, winsock2.h must come before the windows.h GLUT includes
 #include "game/Steps.h" //header for global functions used for checkers game
 #include <ctime> // used for manipulating computer movement speed
 
@@ -39,7 +40,7 @@ void idle_menu_values();  // loades texts and colors for rendering idle menu but
 void hover_menu_values(); // loades texts and colors for rendering idle menu buttons when mouse is hovered
 void render_menu();       // render and print idle menu buttons
 void print_game_menu();   // print text for pause button when game is started
-void change_difficulty(); // to switch between checkers difficulty options (EASY/HARD)
+void change_difficulty(); // to switch between checkers difficulty options (EASY/HARD/MCTS)
 void print_result();      // print result message on the screen when the game is finished
 void multiplayer_click();
 // Checkers events
@@ -74,6 +75,8 @@ Checkers checkers(table_length, table_height, table_width, checkers_cells_row_nu
 GLint mouse_cursor_x = 0.0f, mouse_cursor_y = 0.0f; // for allocating the mouse position at the current time, used for mouse clicks manipulations
 /* Game */
 float count_down = 100;              // count down before switching game event
+clock_t computer_wait_start = 0;     // when the computer's turn started, the step is shown a second later
+bool computer_waiting = false;       // if computer_wait_start is set for the current step
 GLvec3Color start_button_color;      // start background color
 GLvec3Color start_text_color;        // start text color
 GLvec3Color restart_button_color;    // restart background color
@@ -556,11 +559,18 @@ void stone_animations()
 		checkers.isAnimating = false;
 		if (checkers.event.turn == COMPUTER) {
 			if (checkers.doneAnimatingCam) {
-				Sleep(1000);
-				applyComputerStep(checkers);
+				// wait a second without blocking the window, the HARD or MCTS search runs meanwhile
+				if (!computer_waiting) {
+					computer_waiting = true;
+					computer_wait_start = clock();
+					startComputerSearch(checkers);
+				}
+				if (clock() - computer_wait_start >= CLOCKS_PER_SEC && applyComputerStep(checkers))
+					computer_waiting = false;
 			}
 
-		}
+		} else
+			computer_waiting = false;
 	}
 }
 
@@ -589,6 +599,27 @@ void keyboard(unsigned char key, int x, int y)
 		camz++;
 	if (key == 'x')
 		camz--;
+	// switch the pruning of the HARD search, to compare them
+	if (key == '1') {
+		computerSearchOptions.lateMoveReductions = !computerSearchOptions.lateMoveReductions;
+		printf("late move reductions: %s\n", computerSearchOptions.lateMoveReductions ? "on" : "off");
+	}
+	if (key == '2') {
+		computerSearchOptions.nullMove = !computerSearchOptions.nullMove;
+		printf("null move pruning: %s\n", computerSearchOptions.nullMove ? "on" : "off");
+	}
+	if (key == '3') {
+		computerSearchOptions.probCut = !computerSearchOptions.probCut;
+		printf("probcut: %s\n", computerSearchOptions.probCut ? "on" : "off");
+	}
+	if (key == '4') {
+		computerPondering = !computerPondering;
+		printf("pondering: %s\n", computerPondering ? "on" : "off");
+	}
+	if (key == '5') {
+		computerNetwork = !computerNetwork;
+		printf("network evaluation: %s\n", computerNetwork ? "on" : "off");
+	}
 	glutPostRedisplay();
 }
 
@@ -761,6 +792,12 @@ void idle_menu_values()
 		diffeculty_button_color = GLvec3Color(0.16f, 0.0f, 0.28f);
 		/* for drawing text*/
 		diffeculty_text_color = GLvec3Color(1.0, 1.0, 1.0);
+	} else if (checkers.event.difficulty == MCTS)
+	{
+		/* for drawing background*/
+		diffeculty_button_color = GLvec3Color(0.45f, 0.05f, 0.05f);
+		/* for drawing text*/
+		diffeculty_text_color = GLvec3Color(1.0, 1.0, 1.0);
 	} else
 	{
 		/* for drawing background*/
@@ -899,6 +936,23 @@ void render_menu()
 		char *str4 = text4;
 		glRasterPos3f(0.0f, 16.0f, 0.0f);
 		do glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, *str4); while (*(++str4));
+	} else if (checkers.event.difficulty == MCTS)
+	{
+		// background
+		glColor3f(diffeculty_button_color.r, diffeculty_button_color.g, diffeculty_button_color.b);
+		glBegin(GL_QUADS);
+		glVertex3f(-0.5f, 16.0f, -1.2f);
+		glVertex3f(11.2f, 16.0f, -1.2f);
+		glVertex3f(11.2f, 17.0f, -1.2f);
+		glVertex3f(-0.5f, 17.0f, -1.2f);
+		glEnd();
+		// text
+		char text4[38];
+		glColor3f(diffeculty_text_color.r, diffeculty_text_color.g, diffeculty_text_color.b);
+		sprintf_s(text4, "Click here to change difficulty: MCTS");
+		char *str4 = text4;
+		glRasterPos3f(0.0f, 16.0f, 0.0f);
+		do glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, *str4); while (*(++str4));
 	}
 	/*Multiplayer Mode*/
 	if (checkers.event.difficulty == MULTIPLAYER)
@@ -950,12 +1004,14 @@ void print_game_menu()
 	}
 }
 
-/* to switch between checkers difficulty options (EASY/HARD) */
+/* to switch between checkers difficulty options (EASY/HARD/MCTS) */
 void change_difficulty()
 {
 	if (checkers.event.difficulty == EASY)
 		checkers.event.difficulty = HARD;
 	else if (checkers.event.difficulty == HARD)
+		checkers.event.difficulty = MCTS;
+	else if (checkers.event.difficulty == MCTS)
 		checkers.event.difficulty = EASY;
 	else {
 		//Multiplayer Mode
@@ -1020,6 +1076,9 @@ void print_intro()
 	printf("\nDamka3D Game\n");
 	printf("By: Student authors & co-author \n");
 	printf("Checkers game (draughts)  \n");
+	printf("Keys 1, 2, 3 switch late move reductions, null move pruning and probcut of the HARD computer\n");
+	printf("Key 4 switches the HARD computer thinking on your time (pondering)\n");
+	printf("Key 5 switches the HARD computer between the network evaluation (%s) and the classic one\n", NETWORK_FILE);
 	printf("\n");
 }
 
@@ -0,0 +1,456 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   arena.cpp                                                                */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Console tournament between two computer players, games played            */
+/*   in parallel, with the Elo difference and an optional SPRT stop           */
+/* ========================================================================== */
+
+#include "../engine/Search.h"
+#include "../engine/Mcts.h"
+#include <stdio.h>
+#include <stdlib.h> // for atoi and atof
+#include <string.h>
+#include <math.h>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <string>
+
+#define DEFAULT_GAMES 1000
+#define DEFAULT_OPENING_PLIES 6 /* random moves at the start of every pair of games */
+#define DEFAULT_MAX_PLIES 200 /* games longer than that are draws */
+#define DEFAULT_MILLISECONDS 50 /* time per move of a HARD or MCTS player without ms= */
+#define PROGRESS_GAMES 100 /* a progress line is printed every that many games */
+
+struct S_Player /* one side of the match, read from the command line */
+{
+	const char *spec; // the text it was read from, printed as its name
+	bool easy; // plays a random legal move, like the game's EASY mode
+	bool mcts; // plays the move of mctsSearch, like the game's MCTS mode
+	S_SearchLimits limits; // HARD: time, depth and pruning of iterativeDeepening
+	S_MctsLimits mctsLimits; // MCTS: time, playouts and playout policy, one thread
+	int tableMB; // transposition table of the player, 0 for none
+	bool network; // HARD: evaluates with the network of --network instead of evaluateBoard
+};
+
+struct S_PlayerStats /* what a player used over the match */
+{
+	unsigned long long moves;
+	unsigned long long nodes;
+	double seconds;
+};
+
+struct S_Match /* the match state shared by the worker threads, guarded by lock */
+{
+	std::mutex lock;
+	int nextPair; // the pair of games the next free thread plays
+	int wins, draws, losses; // games from the first player's point of view
+	S_PlayerStats stats[2];
+	bool stopped; // SPRT decided, no new pair is started
+	const char *verdict; // SPRT result once stopped
+	FILE *record; // receives every game's moves, NULL when they are not recorded
+};
+
+struct S_Settings /* options of the match */
+{
+	int games;
+	int threads;
+	int openingPlies;
+	int maxPlies;
+	bool sprt;
+	double elo0, elo1, alpha, beta;
+};
+
+/**
+ * Reads an MCTS player's options, "mcts" followed by comma separated options:
+ * ms=<time per move, 0 for none>, playouts=<playouts per move, 0 for none>, light=0|1.
+ * @param spec - The text.
+ * @param player - Receives the player.
+ * @return true when the text was a player.
+ */
+static bool parseMctsPlayer(const char *spec, S_Player &player) {
+	player.mctsLimits = S_MctsLimits();
+	player.mctsLimits.milliseconds = DEFAULT_MILLISECONDS;
+	player.tableMB = 0;
+	for (const char *option = strchr(spec, ','); option; option = strchr(option + 1, ',')) {
+		char name[16];
+		int value;
+		if (sscanf(option + 1, "%15[a-z]=%d", name, &value) != 2)
+			return false;
+		if (strcmp(name, "ms") == 0)
+			player.mctsLimits.milliseconds = value > 0 ? value : -1;
+		else if (strcmp(name, "playouts") == 0)
+			player.mctsLimits.playouts = value > 0 ? value : 0;
+		else if (strcmp(name, "light") == 0)
+			player.mctsLimits.lightPlayouts = value != 0;
+		else
+			return false;
+	}
+	return player.mctsLimits.milliseconds >= 0 || player.mctsLimits.playouts > 0; // a budget, or the search would not end
+}
+
+/**
+ * Reads a player, "easy", "mcts" (see parseMctsPlayer) or "hard" followed by comma separated options:
+ * ms=<time per move, 0 for none>, depth=<last iteration>, lmr=0|1, null=0|1, probcut=0|1, tt=<MB>, nn=0|1.
+ * @param spec - The text.
+ * @param player - Receives the player.
+ * @return true when the text was a player.
+ */
+static bool parsePlayer(const char *spec, S_Player &player) {
+	player.spec = spec;
+	player.easy = strncmp(spec, "easy", 4) == 0;
+	player.mcts = strncmp(spec, "mcts", 4) == 0 && (spec[4] == '\0' || spec[4] == ',');
+	player.limits = S_SearchLimits();
+	player.limits.milliseconds = DEFAULT_MILLISECONDS;
+	player.tableMB = TT_DEFAULT_MB;
+	player.network = false;
+	if (player.easy)
+		return spec[4] == '\0';
+	if (player.mcts)
+		return parseMctsPlayer(spec, player);
+	if (strncmp(spec, "hard", 4) != 0)
+		return false;
+
+	for (const char *option = strchr(spec, ','); option; option = strchr(option + 1, ',')) {
+		char name[16];
+		int value;
+		if (sscanf(option + 1, "%15[a-z]=%d", name, &value) != 2)
+			return false;
+		if (strcmp(name, "ms") == 0)
+			player.limits.milliseconds = value > 0 ? value : -1;
+		else if (strcmp(name, "depth") == 0)
+			player.limits.depth = value < 1 ? 1 : value > MAX_PLY - 2 ? MAX_PLY - 2 : value;
+		else if (strcmp(name, "lmr") == 0)
+			player.limits.options.lateMoveReductions = value != 0;
+		else if (strcmp(name, "null") == 0)
+			player.limits.options.nullMove = value != 0;
+		else if (strcmp(name, "probcut") == 0)
+			player.limits.options.probCut = value != 0;
+		else if (strcmp(name, "tt") == 0)
+			player.tableMB = value < 0 ? 0 : value;
+		else if (strcmp(name, "nn") == 0)
+			player.network = value != 0;
+		else
+			return false;
+	}
+	if (player.limits.milliseconds < 0 && player.limits.depth == MAX_PLY - 2)
+		return false; // neither a time nor a depth, the search would not end
+	return true;
+}
+
+/**
+ * Random numbers of one game, the same on every run and in every thread (xorshift64*).
+ * @param state - The state, not 0.
+ * @return A random number.
+ */
+static unsigned long long nextRandom(unsigned long long &state) {
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545F4914F6CDD1Dull;
+}
+
+/**
+ * Generates the legal moves of the side to move, only the captures when there is one.
+ */
+static void legalMoves(const S_Position &position, S_MoveList &moves) {
+	generateMoves(position, position.turn, moves);
+	if (isThereAttackMoves(moves))
+		filterAttackMoves(moves);
+}
+
+/**
+ * Plays one game.
+ * @param players - The two players, players[first] moves first (as PLAYER).
+ * @param tables - The transposition tables of the two players, cleared here.
+ * @param trees - The trees of the two players when they are MCTS players, cleared here.
+ * @param first - 0 or 1.
+ * @param pair - Number of the pair of games, selects the random opening both games of the pair share.
+ * @param settings - Opening and game length.
+ * @param stats - Receives the moves, nodes and time of both players.
+ * @param record - Receives the moves as text, separated by spaces, NULL when they are not recorded.
+ *                 A "|" follows the random opening, bookgen leaves the moves before it out of the book.
+ * @return 1 if players[0] won, -1 if players[1] won, 0 for a draw.
+ */
+static int playGame(const S_Player *players, S_TransTable *tables, S_MctsTree *trees, int first, int pair, const S_Settings &settings, S_PlayerStats *stats, std::string *record) {
+	unsigned long long openingRandom = 0x9E3779B97F4A7C15ull * (pair + 1);
+	unsigned long long easyRandom = openingRandom ^ (first + 1);
+	for (int i = 0; i < 2; i++) {
+		ttClear(tables[i]);
+		mctsClear(trees[i]);
+	}
+
+	S_Position position = initialPosition();
+	for (int ply = 0; ply < settings.maxPlies; ply++) {
+		const int side = position.turn == PLAYER ? first : 1 - first;
+		S_MoveList moves;
+		legalMoves(position, moves);
+		if (moves.count == 0)
+			return side == 0 ? -1 : 1; // the side to move lost
+
+		if (record && ply == settings.openingPlies)
+			*record += "| ";
+		S_Move move;
+		if (ply < settings.openingPlies) {
+			move = moves.moves[nextRandom(openingRandom) % moves.count];
+		} else if (players[side].easy) {
+			move = moves.moves[nextRandom(easyRandom) % moves.count];
+			stats[side].moves++;
+		} else {
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			const S_SearchResult result = players[side].mcts ? mctsSearch(position, players[side].mctsLimits, trees[side])
+				: iterativeDeepening(position, players[side].limits, tables[side].buckets ? &tables[side] : NULL);
+			stats[side].seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			stats[side].nodes += result.stats.nodes;
+			stats[side].moves++;
+			move = result.move;
+		}
+		if (record) {
+			char text[MOVE_TEXT_SIZE];
+			moveToText(position, move, text);
+			*record += text;
+			*record += ' ';
+		}
+		S_Undo undo;
+		applyMove(position, move, undo);
+	}
+	return 0;
+}
+
+/**
+ * Turns a score fraction into an Elo difference.
+ */
+static double eloFromScore(double score) {
+	if (score <= 0)
+		return -HUGE_VAL;
+	if (score >= 1)
+		return HUGE_VAL;
+	return -400.0 * log10(1.0 / score - 1.0);
+}
+
+/**
+ * Turns an Elo difference into the expected score fraction.
+ */
+static double scoreFromElo(double elo) {
+	return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+/**
+ * Log likelihood ratio of the results for the hypotheses elo1 against elo0,
+ * in the normal approximation of the game results (wins, draws and losses).
+ * @return The ratio, 0 before any game or while every game ended the same.
+ */
+static double sprtLLR(int wins, int draws, int losses, double elo0, double elo1) {
+	const int games = wins + draws + losses;
+	if (games == 0)
+		return 0;
+	const double score = (wins + 0.5 * draws) / games;
+	const double variance = (wins * (1 - score) * (1 - score) + draws * (0.5 - score) * (0.5 - score) + losses * score * score) / games;
+	if (variance <= 0)
+		return 0;
+	const double score0 = scoreFromElo(elo0), score1 = scoreFromElo(elo1);
+	return games * (score1 - score0) * (2 * score - score0 - score1) / (2 * variance);
+}
+
+/**
+ * Plays pairs of games until the match has all its games or the SPRT decided.
+ * Both games of a pair start from the same random opening, with the colours swapped.
+ */
+static void worker(const S_Player *players, const S_Settings &settings, S_Match &match) {
+	S_TransTable tables[2];
+	S_MctsTree trees[2]; // pools allocated by the first search of an MCTS player
+	for (int i = 0; i < 2; i++)
+		if (!players[i].easy && players[i].tableMB > 0)
+			ttResize(tables[i], players[i].tableMB);
+
+	const int pairs = (settings.games + 1) / 2;
+	while (true) {
+		int pair;
+		{
+			std::lock_guard<std::mutex> guard(match.lock);
+			if (match.stopped || match.nextPair >= pairs)
+				return;
+			pair = match.nextPair++;
+		}
+		for (int first = 0; first < 2 && pair * 2 + first < settings.games; first++) {
+			S_PlayerStats stats[2] = {};
+			std::string record;
+			const int result = playGame(players, tables, trees, first, pair, settings, stats, match.record ? &record : NULL);
+
+			std::lock_guard<std::mutex> guard(match.lock);
+			if (match.record) {
+				const int firstResult = first == 0 ? result : -result; // of the side that moved first
+				fprintf(match.record, "%s%s\n", record.c_str(), firstResult > 0 ? "1-0" : firstResult < 0 ? "0-1" : "1/2-1/2");
+			}
+			if (result > 0)
+				match.wins++;
+			else if (result < 0)
+				match.losses++;
+			else
+				match.draws++;
+			for (int i = 0; i < 2; i++) {
+				match.stats[i].moves += stats[i].moves;
+				match.stats[i].nodes += stats[i].nodes;
+				match.stats[i].seconds += stats[i].seconds;
+			}
+			const int played = match.wins + match.draws + match.losses;
+			if (played % PROGRESS_GAMES == 0)
+				printf("%6d games: +%d =%d -%d\n", played, match.wins, match.draws, match.losses);
+			if (settings.sprt && !match.stopped) {
+				const double llr = sprtLLR(match.wins, match.draws, match.losses, settings.elo0, settings.elo1);
+				if (llr >= log((1 - settings.beta) / settings.alpha)) {
+					match.stopped = true;
+					match.verdict = "H1 accepted";
+				} else if (llr <= log(settings.beta / (1 - settings.alpha))) {
+					match.stopped = true;
+					match.verdict = "H0 accepted";
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Prints the time and speed of one player.
+ */
+static void printPlayer(const char *label, const S_Player &player, const S_PlayerStats &stats) {
+	if (player.easy) {
+		printf("%s %s: %llu moves, random\n", label, player.spec, stats.moves);
+		return;
+	}
+	if (player.mcts) {
+		printf("%s %s: %llu moves, %.2f ms/move, %.1f kplayouts/s\n", label, player.spec, stats.moves,
+			stats.moves ? 1000.0 * stats.seconds / stats.moves : 0.0, stats.seconds > 0 ? stats.nodes / stats.seconds / 1e3 : 0.0);
+		return;
+	}
+	printf("%s %s: %llu moves, %.2f ms/move, %.2f Mnodes/s\n", label, player.spec, stats.moves,
+		stats.moves ? 1000.0 * stats.seconds / stats.moves : 0.0, stats.seconds > 0 ? stats.nodes / stats.seconds / 1e6 : 0.0);
+}
+
+static void usage() {
+	printf("usage: arena <player A> <player B> [--games N] [--threads N] [--opening N] [--max-plies N] [--sprt elo0 elo1] [--alpha A] [--beta B] [--tablebase FILE] [--network FILE] [--record FILE]\n");
+	printf("player: easy, or hard with options, e.g. hard,ms=50,lmr=1,null=0,probcut=1,tt=16,nn=1 or hard,depth=6,ms=0\n");
+	printf("        or mcts with options, e.g. mcts,ms=50,light=1 or mcts,playouts=5000,ms=0\n");
+	printf("--tablebase: endgame tablebase written by tbgen, probed by both hard players\n");
+	printf("--network: evaluation network written by nntrain, used by the hard players with nn=1\n");
+	printf("--record: appends the moves of every game to the file, one game per line, a | after the random opening, for bookgen\n");
+}
+
+int main(int argc, char **argv) {
+	S_Player players[2];
+	if (argc < 3 || !parsePlayer(argv[1], players[0]) || !parsePlayer(argv[2], players[1])) {
+		usage();
+		return 2;
+	}
+
+	S_Settings settings;
+	settings.games = DEFAULT_GAMES;
+	settings.threads = (int)std::thread::hardware_concurrency();
+	settings.openingPlies = DEFAULT_OPENING_PLIES;
+	settings.maxPlies = DEFAULT_MAX_PLIES;
+	settings.sprt = false;
+	settings.elo0 = 0;
+	settings.elo1 = 10;
+	settings.alpha = 0.05;
+	settings.beta = 0.05;
+	S_Tablebase tablebase;
+	S_Network *network = NULL; // the weights, shared by both players
+	const char *recordPath = NULL;
+	for (int i = 3; i < argc; i++) {
+		const bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--games") == 0 && hasValue)
+			settings.games = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+			settings.threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--opening") == 0 && hasValue)
+			settings.openingPlies = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--max-plies") == 0 && hasValue)
+			settings.maxPlies = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--sprt") == 0 && i + 2 < argc) {
+			settings.sprt = true;
+			settings.elo0 = atof(argv[++i]);
+			settings.elo1 = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--alpha") == 0 && hasValue)
+			settings.alpha = atof(argv[++i]);
+		else if (strcmp(argv[i], "--beta") == 0 && hasValue)
+			settings.beta = atof(argv[++i]);
+		else if (strcmp(argv[i], "--tablebase") == 0 && hasValue) {
+			if (!tbOpen(tablebase, argv[++i])) {
+				printf("can not read the tablebase %s\n", argv[i]);
+				return 1;
+			}
+			players[0].limits.tablebase = players[1].limits.tablebase = &tablebase;
+		} else if (strcmp(argv[i], "--network") == 0 && hasValue) {
+			network = new S_Network();
+			if (!nnLoad(*network, argv[++i])) {
+				printf("can not read the network %s\n", argv[i]);
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--record") == 0 && hasValue)
+			recordPath = argv[++i];
+		else {
+			usage();
+			return 2;
+		}
+	}
+	if (settings.threads < 1)
+		settings.threads = 1; // hardware_concurrency is 0 when it can not tell
+	for (int side = 0; side < 2; side++) {
+		if (players[side].network && !network) {
+			printf("%s needs --network\n", players[side].spec);
+			return 2;
+		}
+		players[side].limits.network = players[side].network ? network : NULL;
+	}
+	if (settings.games < 1 || settings.alpha <= 0 || settings.beta <= 0 || settings.alpha >= 1 || settings.beta >= 1) {
+		usage();
+		return 2;
+	}
+
+	printf("A: %s\nB: %s\n%d games on %d threads, %d random opening plies, draw after %d plies\n",
+		players[0].spec, players[1].spec, settings.games, settings.threads, settings.openingPlies, settings.maxPlies);
+
+	S_Match match;
+	match.nextPair = 0;
+	match.wins = match.draws = match.losses = 0;
+	memset(match.stats, 0, sizeof(match.stats));
+	match.stopped = false;
+	match.verdict = NULL;
+	match.record = NULL;
+	if (recordPath && !(match.record = fopen(recordPath, "a"))) {
+		printf("can not write the record %s\n", recordPath);
+		return 1;
+	}
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (int i = 0; i < settings.threads; i++)
+		threads.push_back(std::thread(worker, players, std::cref(settings), std::ref(match)));
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (match.record)
+		fclose(match.record);
+
+	const int games = match.wins + match.draws + match.losses;
+	const double score = (match.wins + 0.5 * match.draws) / games;
+	const double variance = (match.wins * (1 - score) * (1 - score) + match.draws * (0.5 - score) * (0.5 - score) + match.losses * score * score) / games;
+	const double margin = 1.96 * sqrt(variance / games); // 95% confidence of the score
+	const double eloLow = eloFromScore(score - margin), eloHigh = eloFromScore(score + margin);
+
+	printf("\n%d games in %.1f s: A +%d =%d -%d, score %.1f%%\n", games, seconds, match.wins, match.draws, match.losses, 100.0 * score);
+	if (isinf(eloLow) || isinf(eloHigh))
+		printf("elo difference: %+.1f, error bars unbounded (too few games or every game won by one side)\n", eloFromScore(score));
+	else
+		printf("elo difference: %+.1f +- %.1f (95%%)\n", eloFromScore(score), (eloHigh - eloLow) / 2);
+	printPlayer("A", players[0], match.stats[0]);
+	printPlayer("B", players[1], match.stats[1]);
+	if (settings.sprt)
+		printf("sprt elo0 %.1f elo1 %.1f alpha %.2f beta %.2f: llr %.2f (%.2f, %.2f), %s\n", settings.elo0, settings.elo1, settings.alpha, settings.beta,
+			sprtLLR(match.wins, match.draws, match.losses, settings.elo0, settings.elo1),
+			log(settings.beta / (1 - settings.alpha)), log((1 - settings.beta) / settings.alpha), match.verdict ? match.verdict : "no decision");
+	return 0;
+}
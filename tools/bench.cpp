@@ -0,0 +1,358 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   bench.cpp                                                                */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Console micro-benchmarks of the engine's hot paths                       */
+/*   on a fixed corpus of positions, as text or JSON                          */
+/* ========================================================================== */
+
+#include "../engine/Search.h"
+#include "../engine/BatchEval.h"
+#include <stdio.h>
+#include <stdlib.h> // for malloc, srand and rand
+#include <string.h>
+#include <new> // for std::bad_alloc
+#include <vector>
+#include <algorithm> // for std::sort
+#include <chrono>
+
+#define CORPUS_GAMES 20 /* games played to collect the corpus */
+#define RANDOM_OPENING_PLIES 6 /* random moves at the start of every game so the games differ */
+#define MAX_GAME_PLIES 150 /* games longer than that are stopped */
+#define CORPUS_SEARCH_DEPTH 4 /* depth of the moves played after the opening */
+#define SAMPLES 200 /* timed samples of every benchmark, the percentiles are taken over them */
+#define MAX_BENCHMARKS 24
+#define SEARCH_TT_MB 16 /* transposition table of the timed searches */
+#define NETWORK_CHECKS 100000 /* random accumulators the network kernels are compared on */
+
+/*
+ * Every allocation of the program goes through these, so a benchmark can tell how many
+ * allocations the code it times made. The engine is meant to make none while searching.
+ */
+static unsigned long long allocations = 0;
+
+void *operator new(size_t size) {
+	allocations++;
+	void *memory = malloc(size ? size : 1);
+	if (!memory)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void *memory) noexcept {
+	free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+	free(memory);
+}
+
+struct S_BenchResult /* timing of one benchmark */
+{
+	const char *name;
+	unsigned long long ops; // operations timed over all samples
+	double nsPerOp; // total time over total operations
+	double allocsPerOp;
+	double p50, p90, p99; // percentiles of the ns/op of the samples
+};
+
+struct S_Corpus /* positions the benchmarks run on, with what the benchmarks need precomputed */
+{
+	std::vector<S_Position> positions;
+	std::vector<S_Move> firstMoves; // first legal move of every position that has one
+	std::vector<S_Position> movable; // the positions firstMoves belong to
+	std::vector<S_MoveList> captureLists; // generated moves of the positions where a capture has to be played
+};
+
+static volatile long long sink; // results go here so the compiler can not drop the timed code
+
+/**
+ * Fills a network with random weights over the whole range of their types, so the kernels meet every
+ * product and sum a trained network could give them (a trained one stays well inside it).
+ * @param network - Receives the weights.
+ */
+static void randomNetwork(S_Network &network) {
+	srand(2018);
+	for (int input = 0; input < NN_INPUTS; input++)
+		for (int i = 0; i < NN_HIDDEN; i++)
+			network.inputWeights[input][i] = (short)(rand() % 161 - 80); // 24 stones stay inside int16
+	for (int i = 0; i < NN_HIDDEN; i++)
+		network.inputBias[i] = (short)(rand() % 255 - 127);
+	for (int j = 0; j < NN_HIDDEN2; j++) {
+		for (int i = 0; i < NN_HIDDEN; i++)
+			network.hiddenWeights[j][i] = (signed char)(rand() % 255 - 127);
+		network.hiddenBias[j] = rand() % 16257 - 8128; // 127 << NN_HIDDEN_SHIFT
+		network.outputWeights[j] = (short)(rand() % 511 - 255);
+	}
+	network.outputBias[0] = rand() % 2001 - 1000;
+	network.outputBias[1] = rand() % 2001 - 1000;
+}
+
+/**
+ * Plays games of the computer against itself, the same games on every run, and collects every position reached.
+ * @param corpus - Receives the positions and the lists and moves precomputed from them.
+ */
+static void buildCorpus(S_Corpus &corpus) {
+	srand(2018);
+	for (int game = 0; game < CORPUS_GAMES; game++) {
+		S_Position position = initialPosition();
+		for (int ply = 0; ply < MAX_GAME_PLIES; ply++) {
+			corpus.positions.push_back(position);
+			S_MoveList moves;
+			generateMoves(position, position.turn, moves);
+			if (isThereAttackMoves(moves)) {
+				corpus.captureLists.push_back(moves);
+				filterAttackMoves(moves);
+			}
+			if (moves.count == 0)
+				break; // game over
+			corpus.movable.push_back(position);
+			corpus.firstMoves.push_back(moves.moves[0]);
+			S_Move move;
+			if (ply < RANDOM_OPENING_PLIES)
+				move = moves.moves[rand() % moves.count];
+			else
+				move = searchRoot(position, CORPUS_SEARCH_DEPTH).move;
+			S_Undo undo;
+			applyMove(position, move, undo);
+		}
+	}
+}
+
+/**
+ * Returns a percentile of sorted values.
+ * @param sorted - The values, smallest first, not empty.
+ * @param percent - The percentile, 0 to 100.
+ */
+static double percentile(const std::vector<double> &sorted, double percent) {
+	const size_t index = (size_t)(percent / 100.0 * (sorted.size() - 1) + 0.5);
+	return sorted[index];
+}
+
+/**
+ * Times a benchmark: one untimed warm up sample, then SAMPLES timed samples.
+ * @param name - Name printed with the result.
+ * @param samples - Number of timed samples.
+ * @param body - Runs the operations of one sample, given the number of the sample, and returns how many it ran.
+ * @return The result.
+ */
+template <class T_Body>
+static S_BenchResult runBench(const char *name, int samples, T_Body body) {
+	body(0); // warm up the caches and the branch predictors
+
+	S_BenchResult result;
+	result.name = name;
+	result.ops = 0;
+	double totalNs = 0;
+	unsigned long long totalAllocations = 0;
+	std::vector<double> sampleNs;
+	for (int sample = 0; sample < samples; sample++) {
+		const unsigned long long allocationsBefore = allocations;
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const long long ops = body(sample);
+		const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		totalAllocations += allocations - allocationsBefore;
+		result.ops += ops;
+		totalNs += ns;
+		sampleNs.push_back(ops ? ns / ops : 0.0);
+	}
+	std::sort(sampleNs.begin(), sampleNs.end());
+	result.nsPerOp = result.ops ? totalNs / result.ops : 0.0;
+	result.allocsPerOp = result.ops ? (double)totalAllocations / result.ops : 0.0;
+	result.p50 = percentile(sampleNs, 50);
+	result.p90 = percentile(sampleNs, 90);
+	result.p99 = percentile(sampleNs, 99);
+	return result;
+}
+
+int main(int argc, char **argv) {
+	const bool json = argc > 1 && strcmp(argv[1], "--json") == 0;
+
+	S_Corpus corpus;
+	buildCorpus(corpus);
+	const std::vector<S_Position> &positions = corpus.positions;
+
+	S_BenchResult results[MAX_BENCHMARKS];
+	int count = 0;
+
+	// one sample is one pass over the corpus, the op is one position
+	results[count++] = runBench("generateMoves", SAMPLES, [&](int) {
+		long long sum = 0;
+		for (size_t i = 0; i < positions.size(); i++) {
+			S_MoveList moves;
+			generateMoves(positions[i], positions[i].turn, moves);
+			sum += moves.count;
+		}
+		sink = sum;
+		return (long long)positions.size();
+	});
+	results[count++] = runBench("applyMove+undoMove", SAMPLES, [&](int) {
+		long long sum = 0;
+		for (size_t i = 0; i < corpus.movable.size(); i++) {
+			S_Position position = corpus.movable[i];
+			S_Undo undo;
+			applyMove(position, corpus.firstMoves[i], undo);
+			sum += position.score;
+			undoMove(position, undo);
+		}
+		sink = sum;
+		return (long long)corpus.movable.size();
+	});
+	results[count++] = runBench("evaluateBoard", SAMPLES, [&](int) {
+		long long sum = 0;
+		for (size_t i = 0; i < positions.size(); i++)
+			sum += evaluateBoard(positions[i]);
+		sink = sum;
+		return (long long)positions.size();
+	});
+	results[count++] = runBench("scorePosition", SAMPLES, [&](int) {
+		long long sum = 0;
+		for (size_t i = 0; i < positions.size(); i++)
+			sum += scorePosition(positions[i]);
+		sink = sum;
+		return (long long)positions.size();
+	});
+	// the batched evaluation on every instruction set the processor has, checked against scorePosition first
+	static const char *const batchNames[EVAL_ISAS] = { "scorePositions scalar", "scorePositions sse4.1", "scorePositions avx2" };
+	int batchResults[EVAL_ISAS];
+	std::vector<int> scores(positions.size());
+	for (int isa = 0; isa < EVAL_ISAS; isa++) {
+		batchResults[isa] = -1;
+		if (!evalIsaSupported((E_EvalIsa)isa))
+			continue;
+		scorePositionsWith((E_EvalIsa)isa, positions.data(), (int)positions.size(), scores.data());
+		for (size_t i = 0; i < positions.size(); i++)
+			if (scores[i] != scorePosition(positions[i])) {
+				printf("%s: position %d scored %d instead of %d\n", evalIsaName((E_EvalIsa)isa), (int)i, scores[i], scorePosition(positions[i]));
+				return 1;
+			}
+		batchResults[isa] = count;
+		results[count++] = runBench(batchNames[isa], SAMPLES, [&](int) {
+			scorePositionsWith((E_EvalIsa)isa, positions.data(), (int)positions.size(), scores.data());
+			sink = scores[positions.size() / 2];
+			return (long long)positions.size();
+		});
+	}
+	// the network inference on every instruction set that has a kernel, checked against the scalar one first with
+	// full range weights and accumulators, many of them saturated, then timed on the accumulators of the corpus
+	static const char *const networkNames[EVAL_ISAS] = { "nnEvaluate scalar", NULL, "nnEvaluate avx2" };
+	static S_Network network; // 17 KB, kept off the stack
+	randomNetwork(network);
+	std::vector<S_Accumulator> accumulators(positions.size());
+	for (size_t i = 0; i < positions.size(); i++)
+		nnRefresh(network, positions[i], accumulators[i]);
+	for (int isa = EVAL_SCALAR + 1; isa < EVAL_ISAS; isa++) {
+		if (!networkNames[isa] || !evalIsaSupported((E_EvalIsa)isa))
+			continue;
+		for (int k = 0; k < NETWORK_CHECKS; k++) {
+			S_Accumulator accumulator;
+			for (int i = 0; i < NN_HIDDEN; i++)
+				accumulator.values[i] = (short)(rand() % 400 - 136); // below 0, inside and above NN_ACTIVATION_SCALE
+			const int turn = k & 1 ? COMPUTER : PLAYER;
+			const int expected = nnEvaluateWith(EVAL_SCALAR, network, accumulator, turn);
+			const int score = nnEvaluateWith((E_EvalIsa)isa, network, accumulator, turn);
+			if (score != expected) {
+				printf("nnEvaluate %s: random accumulator %d scored %d instead of %d\n", evalIsaName((E_EvalIsa)isa), k, score, expected);
+				return 1;
+			}
+		}
+	}
+	for (int isa = 0; isa < EVAL_ISAS; isa++) {
+		if (!networkNames[isa] || !evalIsaSupported((E_EvalIsa)isa))
+			continue;
+		results[count++] = runBench(networkNames[isa], SAMPLES, [&](int) {
+			long long sum = 0;
+			for (size_t i = 0; i < positions.size(); i++)
+				sum += nnEvaluateWith((E_EvalIsa)isa, network, accumulators[i], positions[i].turn);
+			sink = sum;
+			return (long long)positions.size();
+		});
+	}
+	// filtering works in place, so every op copies the generated list first
+	results[count++] = runBench("filterAttackMoves", SAMPLES, [&](int) {
+		long long sum = 0;
+		for (size_t i = 0; i < corpus.captureLists.size(); i++) {
+			S_MoveList moves = corpus.captureLists[i];
+			filterAttackMoves(moves);
+			sum += moves.count;
+		}
+		sink = sum;
+		return (long long)corpus.captureLists.size();
+	});
+	results[count++] = runBench("sideWithoutMoves", SAMPLES, [&](int) {
+		long long sum = 0;
+		for (size_t i = 0; i < positions.size(); i++)
+			sum += sideWithoutMoves(positions[i]);
+		sink = sum;
+		return (long long)positions.size();
+	});
+
+	// one sample is one search of one position of the corpus, the same positions every run
+	// the search the game plays with: iterativeDeepening on one thread, the table kept between the searches as between moves
+	static const char *const searchNames[] = { "iterativeDeepening depth 4", "iterativeDeepening depth 6", "iterativeDeepening depth 8" };
+	int searchResults[4];
+	unsigned long long searchNodes[4];
+	std::vector<unsigned long long> sampleNodes(SAMPLES);
+	S_TransTable table;
+	ttResize(table, SEARCH_TT_MB);
+	for (int d = 0; d < 3; d++) {
+		S_SearchLimits limits;
+		limits.depth = 4 + d * 2;
+		ttClear(table);
+		searchResults[d] = count;
+		results[count++] = runBench(searchNames[d], SAMPLES, [&](int sample) {
+			const S_SearchResult result = iterativeDeepening(positions[(size_t)sample * positions.size() / SAMPLES], limits, &table);
+			sampleNodes[sample] = result.stats.nodes;
+			sink = result.score;
+			return 1LL;
+		});
+		searchNodes[d] = 0;
+		for (int sample = 0; sample < SAMPLES; sample++)
+			searchNodes[d] += sampleNodes[sample];
+	}
+	// the plain minimax the search started from, for reference
+	searchResults[3] = count;
+	results[count++] = runBench("miniMax depth 4 (reference)", SAMPLES, [&](int sample) {
+		S_Position position = positions[(size_t)sample * positions.size() / SAMPLES];
+		S_SearchStats stats;
+		sink = miniMax(position, 4, position.turn, &stats);
+		sampleNodes[sample] = stats.nodes;
+		return 1LL;
+	});
+	searchNodes[3] = 0;
+	for (int sample = 0; sample < SAMPLES; sample++)
+		searchNodes[3] += sampleNodes[sample];
+	static const int searchDepths[4] = { 4, 6, 8, 4 };
+
+	if (json) {
+		printf("{\n  \"corpus\": %d,\n  \"samples\": %d,\n  \"benchmarks\": [\n", (int)positions.size(), SAMPLES);
+		for (int i = 0; i < count; i++)
+			printf("    { \"name\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.2f, \"allocs_per_op\": %.4f, \"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f }%s\n",
+				results[i].name, results[i].ops, results[i].nsPerOp, results[i].allocsPerOp, results[i].p50, results[i].p90, results[i].p99, i + 1 < count ? "," : "");
+		printf("  ],\n  \"batch_evaluation\": {\n    \"selected\": \"%s\"", evalIsaName(evalIsa()));
+		for (int isa = 0; isa < EVAL_ISAS; isa++)
+			if (batchResults[isa] >= 0)
+				printf(",\n    \"%s_positions_per_second\": %.0f", evalIsaName((E_EvalIsa)isa), 1e9 / results[batchResults[isa]].nsPerOp);
+		printf("\n  },\n  \"search\": [\n");
+		for (int i = 0; i < 4; i++)
+			printf("    { \"name\": \"%s\", \"depth\": %d, \"nodes_per_search\": %.0f, \"nodes_per_second\": %.0f }%s\n", results[searchResults[i]].name, searchDepths[i],
+				(double)searchNodes[i] / SAMPLES, searchNodes[i] * 1e9 / (results[searchResults[i]].nsPerOp * SAMPLES), i < 3 ? "," : "");
+		printf("  ]\n}\n");
+	} else {
+		printf("corpus: %d positions from %d games, %d samples per benchmark\n", (int)positions.size(), CORPUS_GAMES, SAMPLES);
+		printf("%-27s | %12s | %12s | %10s | %12s | %12s | %12s\n", "benchmark", "ops", "ns/op", "allocs/op", "p50 ns/op", "p90 ns/op", "p99 ns/op");
+		for (int i = 0; i < count; i++)
+			printf("%-27s | %12llu | %12.1f | %10.4f | %12.1f | %12.1f | %12.1f\n",
+				results[i].name, results[i].ops, results[i].nsPerOp, results[i].allocsPerOp, results[i].p50, results[i].p90, results[i].p99);
+		printf("batch evaluation, %s selected:", evalIsaName(evalIsa()));
+		for (int isa = 0; isa < EVAL_ISAS; isa++)
+			if (batchResults[isa] >= 0)
+				printf(" | %s %.1f Mpositions/s", evalIsaName((E_EvalIsa)isa), 1e3 / results[batchResults[isa]].nsPerOp);
+		printf("\n");
+		for (int i = 0; i < 4; i++)
+			printf("%s: %.0f nodes per search, %.2f Mnodes/s\n", results[searchResults[i]].name, (double)searchNodes[i] / SAMPLES,
+				searchNodes[i] * 1e3 / (results[searchResults[i]].nsPerOp * SAMPLES));
+	}
+	return 0;
+}
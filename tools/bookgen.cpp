@@ -0,0 +1,241 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   bookgen.cpp                                                              */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Console builder of the opening book: counts the moves played             */
+/*   in the first plies of recorded games and weights them by the results     */
+/* ========================================================================== */
+
+#include "../engine/Book.h"
+#include <stdio.h>
+#include <stdlib.h> // for atoi
+#include <string.h>
+#include <ctype.h> // for isspace
+#include <vector>
+#include <algorithm> // for std::sort
+
+#define DEFAULT_FILE "checkers.book"
+#define DEFAULT_PLIES 20 /* plies of every game that go into the book */
+#define DEFAULT_MIN_GAMES 2 /* games a move must be played in to be a book move */
+#define MAX_LINE 65536 /* longest line of the games file */
+
+struct S_Occurrence /* one move played in one game */
+{
+	S_Position position; // before the move
+	S_Move move;
+	int points; // of the side that played it: 2 for a win, 1 for a draw, 0 for a loss
+};
+
+struct S_BookMove /* every occurrence of one move of one position */
+{
+	S_Position position;
+	S_Move move;
+	int games;
+	int points;
+};
+
+/**
+ * Orders the occurrences by position, then move, so the same moves are next to each other.
+ */
+static bool occurrenceBefore(const S_Occurrence &a, const S_Occurrence &b) {
+	if (a.position.hash != b.position.hash)
+		return a.position.hash < b.position.hash;
+	if (a.move.from != b.move.from)
+		return a.move.from < b.move.from;
+	if (a.move.to != b.move.to)
+		return a.move.to < b.move.to;
+	return a.move.captured < b.move.captured;
+}
+
+/**
+ * Reads one game, a line of moves in the text of moveToText separated by spaces, followed by the result:
+ * "1-0" when the side that moved first won, "0-1" when it lost, "1/2-1/2" for a draw (arena --record writes these).
+ * A "|" between the moves ends an opening that was not chosen by the players, arena's random plies:
+ * the moves before it are played to reach the position but are not book moves.
+ * @param line - The line.
+ * @param plies - Moves to keep from the start of the game, or from the "|".
+ * @param occurrences - Receives the first plies moves.
+ * @return false when a move is not legal or the result is missing, nothing was added then.
+ */
+static bool readGame(const char *line, int plies, std::vector<S_Occurrence> &occurrences) {
+	std::vector<S_Occurrence> game;
+	S_Position position = initialPosition();
+	int firstPoints = -1;
+	bool openingSkipped = false;
+	const char *text = line;
+	while (true) {
+		while (isspace((unsigned char)*text))
+			text++;
+		if (!*text)
+			break;
+		if (firstPoints >= 0)
+			return false; // something after the result
+		if (strncmp(text, "1/2-1/2", 7) == 0 || strncmp(text, "1-0", 3) == 0 || strncmp(text, "0-1", 3) == 0) {
+			firstPoints = text[1] == '/' ? 1 : text[0] == '1' ? 2 : 0;
+			text += text[1] == '/' ? 7 : 3;
+			continue;
+		}
+		if (*text == '|' && (isspace((unsigned char)text[1]) || !text[1])) {
+			if (openingSkipped)
+				return false; // a second opening
+			openingSkipped = true;
+			game.clear(); // random moves, not book moves
+			text++;
+			continue;
+		}
+		S_Occurrence occurrence;
+		const int length = moveFromText(position, text, occurrence.move);
+		if (length == 0 || !(isspace((unsigned char)text[length]) || !text[length]))
+			return false;
+		text += length;
+		occurrence.position = position;
+		if ((int)game.size() < plies)
+			game.push_back(occurrence);
+		S_Undo undo;
+		applyMove(position, occurrence.move, undo);
+	}
+	if (firstPoints < 0)
+		return false;
+	for (size_t i = 0; i < game.size(); i++) {
+		game[i].points = game[i].position.turn == PLAYER ? firstPoints : 2 - firstPoints; // PLAYER moves first
+		occurrences.push_back(game[i]);
+	}
+	return true;
+}
+
+/**
+ * Writes the book file, see the layout in Book.h.
+ * @param moves - The book moves, sorted by hash.
+ * @return The size of the file, 0 when it could not be written.
+ */
+static unsigned long long writeBook(const std::vector<S_BookMove> &moves, const char *path) {
+	FILE *file = fopen(path, "wb");
+	if (!file)
+		return 0;
+	S_BookHeader header = { BOOK_MAGIC, BOOK_VERSION, moves.size() };
+	fwrite(&header, sizeof(header), 1, file);
+	for (size_t begin = 0, end; begin < moves.size(); begin = end) {
+		// The points of a position's moves are its weights, scaled down together when one does not fit
+		int most = 0;
+		for (end = begin; end < moves.size() && moves[end].position.hash == moves[begin].position.hash; end++)
+			most = std::max(most, moves[end].points);
+		for (size_t i = begin; i < end; i++) {
+			S_BookEntry entry;
+			entry.hash = moves[i].position.hash;
+			entry.captured = moves[i].move.captured;
+			entry.from = moves[i].move.from;
+			entry.to = moves[i].move.to;
+			const long long weight = most > BOOK_MAX_WEIGHT ? (long long)moves[i].points * BOOK_MAX_WEIGHT / most : moves[i].points;
+			entry.weight = (unsigned short)(weight > 0 ? weight : 1);
+			fwrite(&entry, sizeof(entry), 1, file);
+		}
+	}
+	const bool written = !ferror(file);
+	fclose(file);
+	return written ? sizeof(header) + moves.size() * sizeof(S_BookEntry) : 0;
+}
+
+/**
+ * Looks up every position of the written file and compares its moves with the ones written.
+ * @return The number of positions whose moves differ.
+ */
+static int verifyBook(const std::vector<S_BookMove> &moves, const char *path) {
+	S_Book book;
+	if (!bookOpen(book, path)) {
+		printf("%s can not be opened as a book\n", path);
+		return 1;
+	}
+	int wrong = 0;
+	for (size_t begin = 0, end; begin < moves.size(); begin = end) {
+		for (end = begin; end < moves.size() && moves[end].position.hash == moves[begin].position.hash; end++)
+			;
+		S_Move found[MAX_MOVES];
+		int weights[MAX_MOVES];
+		const int count = bookMoves(book, moves[begin].position, found, weights);
+		bool same = count == (int)(end - begin);
+		for (size_t i = begin; same && i < end; i++) {
+			same = false;
+			for (int j = 0; j < count && !same; j++)
+				same = sameMove(found[j], moves[i].move);
+		}
+		if (!same)
+			wrong++;
+	}
+	return wrong;
+}
+
+int main(int argc, char **argv) {
+	const char *gamesPath = NULL;
+	const char *path = DEFAULT_FILE;
+	int plies = DEFAULT_PLIES, minGames = DEFAULT_MIN_GAMES;
+	int positional = 0;
+	bool valid = true;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--plies") == 0 && i + 1 < argc)
+			plies = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--min-games") == 0 && i + 1 < argc)
+			minGames = atoi(argv[++i]);
+		else if (positional == 0 && argv[i][0] != '-')
+			gamesPath = argv[i], positional++;
+		else if (positional == 1 && argv[i][0] != '-')
+			path = argv[i], positional++;
+		else
+			valid = false;
+	}
+	if (!valid || !gamesPath || plies < 1 || minGames < 1) {
+		printf("usage: bookgen <games file> [book file] [--plies N] [--min-games N]\n");
+		printf("games file: one game per line, e.g. \"22-18 10-13 | 18-14 11x18 21x14 ... 1-0\", as arena --record writes it,\n");
+		printf("the moves before the | are a random opening, not book moves\n");
+		return 2;
+	}
+
+	FILE *games = fopen(gamesPath, "r");
+	if (!games) {
+		printf("%s can not be read\n", gamesPath);
+		return 1;
+	}
+	std::vector<S_Occurrence> occurrences;
+	std::vector<char> line(MAX_LINE);
+	int lineNumber = 0, read = 0, skipped = 0;
+	while (fgets(line.data(), MAX_LINE, games)) {
+		lineNumber++;
+		if (strspn(line.data(), " \t\r\n") == strlen(line.data()))
+			continue; // empty line
+		if (readGame(line.data(), plies, occurrences))
+			read++;
+		else {
+			if (skipped++ < 10)
+				printf("line %d: not a game, skipped\n", lineNumber);
+		}
+	}
+	fclose(games);
+
+	// Sum the occurrences of every move, keep the ones played often enough that did not only lose
+	std::sort(occurrences.begin(), occurrences.end(), occurrenceBefore);
+	std::vector<S_BookMove> moves;
+	int positions = 0;
+	for (size_t begin = 0, end; begin < occurrences.size(); begin = end) {
+		S_BookMove move = { occurrences[begin].position, occurrences[begin].move, 0, 0 };
+		for (end = begin; end < occurrences.size() && !occurrenceBefore(occurrences[begin], occurrences[end]); end++) {
+			move.games++;
+			move.points += occurrences[end].points;
+		}
+		if (move.games < minGames || move.points == 0)
+			continue;
+		if (moves.empty() || moves.back().position.hash != move.position.hash)
+			positions++;
+		moves.push_back(move);
+	}
+
+	const unsigned long long bytes = writeBook(moves, path);
+	if (!bytes) {
+		printf("%s can not be written\n", path);
+		return 1;
+	}
+	printf("%d games read (%d skipped), first %d plies after the random openings: %d positions, %d moves, %s written: %llu bytes\n",
+		read, skipped, plies, positions, (int)moves.size(), path, bytes);
+	const int wrong = verifyBook(moves, path);
+	printf("lookup check: %d positions read back wrong\n", wrong);
+	return wrong ? 1 : 0;
+}
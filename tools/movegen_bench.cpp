@@ -0,0 +1,195 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   movegen_bench.cpp                                                        */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Console benchmark of the table driven move generator                     */
+/*   against the row/col walking generator it replaced                        */
+/* ========================================================================== */
+
+#include "../engine/Search.h"
+#include <stdio.h>
+#include <stdlib.h> // for srand and rand
+#include <vector>
+#include <chrono>
+
+#define CORPUS_GAMES 40 /* games played to collect the corpus */
+#define RANDOM_OPENING_PLIES 6 /* random moves at the start of every game so the games differ */
+#define MAX_GAME_PLIES 150 /* games longer than that are stopped */
+#define SEARCH_DEPTH 4 /* depth of the moves played after the opening */
+#define REPEATS 200 /* passes over the corpus for every timing */
+
+static const int directionRow[4] = { 1, 1, -1, -1 };
+static const int directionCol[4] = { 1, -1, 1, -1 };
+
+/**
+ * Follows the jumps of one stone by row and col, adding every complete jump sequence as one move.
+ * @param moves - The list to add to.
+ * @param from - Square the stone started the turn on.
+ * @param row, col - Block the stone landed on after the last jump.
+ * @param king - Whether the stone may jump backward.
+ * @param turn - The player moving the stone.
+ * @param occupied - Stones of both sides, the moving stone left out.
+ * @param opponent - Stones of the other side.
+ * @param captured - Squares jumped so far.
+ * @param jumps - Number of squares jumped so far.
+ */
+static void referenceJumps(S_MoveList &moves, int from, int row, int col, bool king, int turn, Bitboard occupied, Bitboard opponent, Bitboard captured, int jumps) {
+	bool jumped = false;
+	if (king || row != (turn == COMPUTER ? BOARD_ROWS - 1 : 0)) { // a man crowned by a jump ends the turn
+		for (int direction = 0; direction < 4; direction++) {
+			if (!king && directionRow[direction] != (turn == COMPUTER ? 1 : -1))
+				continue; // men can not move backward
+			const int nextrow = row + directionRow[direction], nextcol = col + directionCol[direction];
+			const int newrow = nextrow + directionRow[direction], newcol = nextcol + directionCol[direction];
+			if (newrow < 0 || newrow >= BOARD_ROWS || newcol < 0 || newcol >= BOARD_ROWS)
+				continue; // out of bounds
+			const Bitboard next = squareMask(squareIndex(nextrow, nextcol));
+			if (!(opponent & next) || (captured & next) || (occupied & squareMask(squareIndex(newrow, newcol))))
+				continue; // nothing to jump, jumped already or the one after it is occupied
+			referenceJumps(moves, from, newrow, newcol, king, turn, occupied, opponent, captured | next, jumps + 1);
+			jumped = true;
+		}
+	}
+	if (!jumped) {
+		S_Move &move = moves.moves[moves.count++];
+		move.from = (unsigned char)from;
+		move.to = (unsigned char)squareIndex(row, col);
+		move.attack = (unsigned char)jumps;
+		move.captured = captured;
+	}
+}
+
+/**
+ * Generates all possible moves walking the board by row and col and checking the bounds of every step.
+ * This is how the generator worked before the neighbour and jump tables, kept as the reference.
+ * @param position - The current position.
+ * @param turn - The player to generate moves for (PLAYER or COMPUTER).
+ * @param moves - Receives the moves, count is 0 if there are none.
+ */
+static void referenceGenerateMoves(const S_Position &position, int turn, S_MoveList &moves) {
+	moves.count = 0;
+
+	const Bitboard own = turn == COMPUTER ? position.black : position.white;
+	const Bitboard occupied = position.black | position.white;
+	const Bitboard opponent = occupied & ~own;
+
+	for (int row = 0; row < BOARD_ROWS; row++) {
+		for (int col = row % 2; col < BOARD_ROWS; col += 2) {
+			if (!(own & squareMask(squareIndex(row, col))))
+				continue;
+			const bool king = (position.kings & squareMask(squareIndex(row, col))) != 0;
+			for (int direction = 0; direction < 4; direction++) {
+				if (!king && directionRow[direction] != (turn == COMPUTER ? 1 : -1))
+					continue; // men can not move backward
+				const int nextrow = row + directionRow[direction];
+				const int nextcol = col + directionCol[direction];
+				if (nextrow < 0 || nextrow >= BOARD_ROWS || nextcol < 0 || nextcol >= BOARD_ROWS)
+					continue; // out of bounds
+				if (occupied & squareMask(squareIndex(nextrow, nextcol))) { // if blocked
+					if (!(opponent & squareMask(squareIndex(nextrow, nextcol))))
+						continue; // same type
+					const int newrow = nextrow + directionRow[direction];
+					const int newcol = nextcol + directionCol[direction];
+					if (newrow < 0 || newrow >= BOARD_ROWS || newcol < 0 || newcol >= BOARD_ROWS)
+						continue; // out of bounds
+					if (occupied & squareMask(squareIndex(newrow, newcol)))
+						continue; // the one after it is occupied
+					referenceJumps(moves, squareIndex(row, col), newrow, newcol, king, turn, occupied & ~squareMask(squareIndex(row, col)),
+						opponent, squareMask(squareIndex(nextrow, nextcol)), 1);
+					continue;
+				}
+				S_Move &move = moves.moves[moves.count++];
+				move.from = (unsigned char)squareIndex(row, col);
+				move.to = (unsigned char)squareIndex(nextrow, nextcol);
+				move.attack = 0;
+				move.captured = 0;
+			}
+		}
+	}
+}
+
+/**
+ * Plays games of the computer against itself and collects every position reached.
+ * @param corpus - Receives the positions.
+ */
+static void buildCorpus(std::vector<S_Position> &corpus) {
+	srand(2018);
+	for (int game = 0; game < CORPUS_GAMES; game++) {
+		S_Position position = initialPosition();
+		for (int ply = 0; ply < MAX_GAME_PLIES; ply++) {
+			corpus.push_back(position);
+			S_MoveList moves;
+			generateMoves(position, position.turn, moves);
+			if (isThereAttackMoves(moves))
+				filterAttackMoves(moves);
+			if (moves.count == 0)
+				break; // game over
+			S_Move move;
+			if (ply < RANDOM_OPENING_PLIES)
+				move = moves.moves[rand() % moves.count];
+			else
+				move = searchRoot(position, SEARCH_DEPTH).move;
+			S_Undo undo;
+			applyMove(position, move, undo);
+		}
+	}
+}
+
+/**
+ * Compares two move lists, move by move.
+ * @return 1 if both lists hold the same moves in the same order, 0 otherwise.
+ */
+static int sameMoves(const S_MoveList &a, const S_MoveList &b) {
+	if (a.count != b.count)
+		return 0;
+	for (int i = 0; i < a.count; i++) {
+		if (!sameMove(a.moves[i], b.moves[i]) || a.moves[i].attack != b.moves[i].attack)
+			return 0;
+	}
+	return 1;
+}
+
+/**
+ * Times one generator over the corpus, both sides to move in every position.
+ * @return Average nanoseconds per call.
+ */
+static double timeGenerator(void (*generator)(const S_Position &, int, S_MoveList &), const std::vector<S_Position> &corpus, int &checksum) {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int repeat = 0; repeat < REPEATS; repeat++)
+		for (size_t i = 0; i < corpus.size(); i++)
+			for (int turn = PLAYER; turn <= COMPUTER; turn++) {
+				S_MoveList moves;
+				generator(corpus[i], turn, moves);
+				if (moves.count)
+					checksum += moves.moves[0].to;
+			}
+	const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	return elapsed / ((double)REPEATS * corpus.size() * 2);
+}
+
+int main() {
+	std::vector<S_Position> corpus;
+	buildCorpus(corpus);
+	printf("corpus: %d positions from %d games\n", (int)corpus.size(), CORPUS_GAMES);
+
+	// the table driven generator must produce exactly the moves of the reference
+	int mismatches = 0;
+	for (size_t i = 0; i < corpus.size(); i++)
+		for (int turn = PLAYER; turn <= COMPUTER; turn++) {
+			S_MoveList reference, moves;
+			referenceGenerateMoves(corpus[i], turn, reference);
+			generateMoves(corpus[i], turn, moves);
+			if (!sameMoves(reference, moves))
+				mismatches++;
+		}
+	printf("move lists differing from the reference: %d\n", mismatches);
+
+	int checksum = 0;
+	const double referenceTime = timeGenerator(referenceGenerateMoves, corpus, checksum);
+	const double tableTime = timeGenerator(generateMoves, corpus, checksum);
+	printf("reference generator: %8.1f ns/call\n", referenceTime);
+	printf("table generator:     %8.1f ns/call\n", tableTime);
+	printf("speedup:             %8.2fx (checksum %d)\n", referenceTime / tableTime, checksum);
+	return mismatches ? 1 : 0;
+}
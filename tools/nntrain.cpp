@@ -0,0 +1,374 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   nntrain.cpp                                                              */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Console trainer of the evaluation network: learns the scores of          */
+/*   searches of self-play positions, writes the quantised weights            */
+/* ========================================================================== */
+
+#include "../engine/Search.h"
+#include <stdio.h>
+#include <stdlib.h> // for atoi
+#include <string.h>
+#include <math.h>
+#include <thread>
+#include <vector>
+#include <random>
+#include <algorithm> // for std::shuffle, std::min and std::max
+#include <chrono>
+
+#define DEFAULT_FILE "checkers.nn"
+#define DEFAULT_POSITIONS 200000 /* positions searched for the training data */
+#define DEFAULT_DEPTH 4 /* depth of the searches whose scores the network learns */
+#define DEFAULT_EPOCHS 12
+#define RANDOM_OPENING_PLIES 8 /* random moves at the start of every game so the games differ */
+#define RANDOM_MOVE_PERCENT 10 /* moves played at random after the opening, so the games reach unusual positions too */
+#define MOVE_SEARCH_DEPTH 2 /* depth of the other moves of the games */
+#define MAX_GAME_PLIES 200
+#define TT_MB 16 /* transposition table of every thread's searches */
+#define LABEL_LIMIT 2000 /* scores are clamped to it, the decided positions all look alike */
+#define SIGMOID_SCALE 300.0 /* scores are compared as win chances, sigmoid(score / SIGMOID_SCALE) */
+#define BATCH_SIZE 256
+#define LEARNING_RATE 0.001
+#define VALIDATION_PERCENT 5 /* positions kept out of the training to measure the loss on */
+#define MAX_INPUT_WEIGHT 8.0f /* keeps the accumulator of 24 stones inside int16 */
+#define MAX_HIDDEN_WEIGHT (127.0f / (1 << NN_HIDDEN_SHIFT)) /* the largest int8 second layer weight */
+
+struct S_Sample /* one position of the training data */
+{
+	unsigned char features[24]; // inputs of its stones, see nnFeature
+	unsigned char featureCount;
+	unsigned char turn; // side to move
+	float score; // search score from the COMPUTER's point of view, clamped to LABEL_LIMIT
+	int classic; // evaluateBoard of the position, to compare the network with
+};
+
+/*
+ * Float copy of S_Network that is trained, one flat array so the optimizer walks every weight alike.
+ * The offsets give where each member of S_Network starts.
+ */
+enum E_Parameter
+{
+	P_INPUT_WEIGHTS = 0,
+	P_INPUT_BIAS = P_INPUT_WEIGHTS + NN_INPUTS * NN_HIDDEN,
+	P_HIDDEN_WEIGHTS = P_INPUT_BIAS + NN_HIDDEN,
+	P_HIDDEN_BIAS = P_HIDDEN_WEIGHTS + NN_HIDDEN2 * NN_HIDDEN,
+	P_OUTPUT_WEIGHTS = P_HIDDEN_BIAS + NN_HIDDEN2,
+	P_OUTPUT_BIAS = P_OUTPUT_WEIGHTS + NN_HIDDEN2,
+	P_COUNT = P_OUTPUT_BIAS + 2
+};
+
+struct S_Trainer
+{
+	std::vector<float> parameters, gradients;
+	std::vector<float> moment, velocity; // Adam's running averages of the gradients and of their squares
+	int steps;
+};
+
+/**
+ * Turns a position into a sample.
+ */
+static S_Sample makeSample(const S_Position &position, int score) {
+	S_Sample sample;
+	sample.featureCount = 0;
+	for (Bitboard stones = position.white | position.black; stones; stones &= stones - 1) {
+		const int square = lowestSquare(stones);
+		sample.features[sample.featureCount++] = (unsigned char)nnFeature((position.black & squareMask(square)) ? COMPUTER : PLAYER,
+			(position.kings & squareMask(square)) != 0, square);
+	}
+	sample.turn = (unsigned char)position.turn;
+	sample.score = (float)std::max(-LABEL_LIMIT, std::min(LABEL_LIMIT, score));
+	sample.classic = evaluateBoard(position);
+	return sample;
+}
+
+/**
+ * Plays games, with some random moves, and searches their quiet positions for the training data.
+ * @param seed - Random seed of the thread.
+ * @param count - Samples to collect.
+ * @param depth - Depth of the searches of the samples.
+ * @param samples - Receives the samples.
+ */
+static void collectSamples(unsigned int seed, int count, int depth, std::vector<S_Sample> *samples) {
+	std::mt19937 random(seed);
+	S_TransTable table;
+	ttResize(table, TT_MB);
+	while ((int)samples->size() < count) {
+		S_Position position = initialPosition();
+		for (int ply = 0; ply < MAX_GAME_PLIES && (int)samples->size() < count; ply++) {
+			S_MoveList moves;
+			generateMoves(position, position.turn, moves);
+			const bool captures = isThereAttackMoves(moves) != 0;
+			if (captures)
+				filterAttackMoves(moves);
+			if (moves.count == 0)
+				break; // game over
+			if (!captures && ply >= RANDOM_OPENING_PLIES) { // the network only evaluates quiet positions
+				const int score = searchRoot(position, depth, &table).score;
+				samples->push_back(makeSample(position, position.turn == COMPUTER ? score : -score));
+			}
+			S_Move move;
+			if (ply < RANDOM_OPENING_PLIES || (int)(random() % 100) < RANDOM_MOVE_PERCENT)
+				move = moves.moves[random() % moves.count];
+			else
+				move = searchRoot(position, MOVE_SEARCH_DEPTH, &table).move;
+			S_Undo undo;
+			applyMove(position, move, undo);
+		}
+	}
+}
+
+static inline float sigmoid(float x) {
+	return 1.0f / (1.0f + expf(-x));
+}
+
+static inline float clampf(float x, float low, float high) {
+	return x < low ? low : x > high ? high : x;
+}
+
+/**
+ * Runs the float network on a sample, and when gradients is not NULL adds the gradients of its loss.
+ * @return The squared error of the win chance.
+ */
+static float trainSample(const std::vector<float> &p, const S_Sample &sample, float *gradients) {
+	float a1[NN_HIDDEN], h1[NN_HIDDEN], a2[NN_HIDDEN2], h2[NN_HIDDEN2];
+	for (int i = 0; i < NN_HIDDEN; i++)
+		a1[i] = p[P_INPUT_BIAS + i];
+	for (int f = 0; f < sample.featureCount; f++) {
+		const float *row = &p[P_INPUT_WEIGHTS + sample.features[f] * NN_HIDDEN];
+		for (int i = 0; i < NN_HIDDEN; i++)
+			a1[i] += row[i];
+	}
+	for (int i = 0; i < NN_HIDDEN; i++)
+		h1[i] = clampf(a1[i], 0, 1);
+	for (int j = 0; j < NN_HIDDEN2; j++) {
+		float sum = p[P_HIDDEN_BIAS + j];
+		for (int i = 0; i < NN_HIDDEN; i++)
+			sum += p[P_HIDDEN_WEIGHTS + j * NN_HIDDEN + i] * h1[i];
+		a2[j] = sum;
+		h2[j] = clampf(sum, 0, 1);
+	}
+	float output = p[P_OUTPUT_BIAS + (sample.turn == COMPUTER ? 1 : 0)];
+	for (int j = 0; j < NN_HIDDEN2; j++)
+		output += p[P_OUTPUT_WEIGHTS + j] * h2[j];
+
+	const float scale = (float)(MAN_VALUE / SIGMOID_SCALE); // the output counts men
+	const float predicted = sigmoid(output * scale), target = sigmoid(sample.score / (float)SIGMOID_SCALE);
+	const float error = predicted - target;
+	if (!gradients)
+		return error * error;
+
+	// Back propagation, the clipped ReLU passes the gradient only between its bounds
+	const float dOutput = 2 * error * predicted * (1 - predicted) * scale;
+	gradients[P_OUTPUT_BIAS + (sample.turn == COMPUTER ? 1 : 0)] += dOutput;
+	float dH1[NN_HIDDEN] = {};
+	for (int j = 0; j < NN_HIDDEN2; j++) {
+		gradients[P_OUTPUT_WEIGHTS + j] += dOutput * h2[j];
+		if (a2[j] <= 0 || a2[j] >= 1)
+			continue;
+		const float dA2 = dOutput * p[P_OUTPUT_WEIGHTS + j];
+		gradients[P_HIDDEN_BIAS + j] += dA2;
+		for (int i = 0; i < NN_HIDDEN; i++) {
+			gradients[P_HIDDEN_WEIGHTS + j * NN_HIDDEN + i] += dA2 * h1[i];
+			dH1[i] += dA2 * p[P_HIDDEN_WEIGHTS + j * NN_HIDDEN + i];
+		}
+	}
+	for (int i = 0; i < NN_HIDDEN; i++)
+		if (a1[i] <= 0 || a1[i] >= 1)
+			dH1[i] = 0;
+	for (int i = 0; i < NN_HIDDEN; i++)
+		gradients[P_INPUT_BIAS + i] += dH1[i];
+	for (int f = 0; f < sample.featureCount; f++) {
+		float *row = &gradients[P_INPUT_WEIGHTS + sample.features[f] * NN_HIDDEN];
+		for (int i = 0; i < NN_HIDDEN; i++)
+			row[i] += dH1[i];
+	}
+	return error * error;
+}
+
+/**
+ * One Adam step with the gradients of a batch, then the weights are clipped to what the quantised network can hold.
+ */
+static void adamStep(S_Trainer &trainer, int batch) {
+	const float beta1 = 0.9f, beta2 = 0.999f, epsilon = 1e-8f;
+	trainer.steps++;
+	const float correction1 = 1 - powf(beta1, (float)trainer.steps), correction2 = 1 - powf(beta2, (float)trainer.steps);
+	for (int k = 0; k < P_COUNT; k++) {
+		const float gradient = trainer.gradients[k] / batch;
+		trainer.moment[k] = beta1 * trainer.moment[k] + (1 - beta1) * gradient;
+		trainer.velocity[k] = beta2 * trainer.velocity[k] + (1 - beta2) * gradient * gradient;
+		trainer.parameters[k] -= (float)LEARNING_RATE * (trainer.moment[k] / correction1) / (sqrtf(trainer.velocity[k] / correction2) + epsilon);
+		trainer.gradients[k] = 0;
+	}
+	for (int k = P_INPUT_WEIGHTS; k < P_HIDDEN_WEIGHTS; k++)
+		trainer.parameters[k] = clampf(trainer.parameters[k], -MAX_INPUT_WEIGHT, MAX_INPUT_WEIGHT);
+	for (int k = P_HIDDEN_WEIGHTS; k < P_HIDDEN_BIAS; k++)
+		trainer.parameters[k] = clampf(trainer.parameters[k], -MAX_HIDDEN_WEIGHT, MAX_HIDDEN_WEIGHT);
+}
+
+/**
+ * Rounds a float weight times its scale to the nearest integer.
+ */
+static long long quantise(float value, double scale) {
+	return (long long)floor(value * scale + 0.5);
+}
+
+/**
+ * Writes the quantised network, see the layout in Network.h.
+ * @return false when the file could not be written.
+ */
+static bool writeNetwork(const std::vector<float> &p, const char *path) {
+	S_Network *network = new S_Network();
+	for (int k = 0; k < NN_INPUTS * NN_HIDDEN; k++)
+		network->inputWeights[k / NN_HIDDEN][k % NN_HIDDEN] = (short)quantise(p[P_INPUT_WEIGHTS + k], NN_ACTIVATION_SCALE);
+	for (int i = 0; i < NN_HIDDEN; i++)
+		network->inputBias[i] = (short)quantise(p[P_INPUT_BIAS + i], NN_ACTIVATION_SCALE);
+	for (int k = 0; k < NN_HIDDEN2 * NN_HIDDEN; k++)
+		network->hiddenWeights[k / NN_HIDDEN][k % NN_HIDDEN] = (signed char)quantise(p[P_HIDDEN_WEIGHTS + k], 1 << NN_HIDDEN_SHIFT);
+	for (int j = 0; j < NN_HIDDEN2; j++) {
+		network->hiddenBias[j] = (int)quantise(p[P_HIDDEN_BIAS + j], NN_ACTIVATION_SCALE << NN_HIDDEN_SHIFT);
+		network->outputWeights[j] = (short)quantise(p[P_OUTPUT_WEIGHTS + j], NN_OUTPUT_SCALE);
+	}
+	for (int t = 0; t < 2; t++)
+		network->outputBias[t] = (int)quantise(p[P_OUTPUT_BIAS + t], NN_ACTIVATION_SCALE * NN_OUTPUT_SCALE);
+
+	FILE *file = fopen(path, "wb");
+	if (!file) {
+		delete network;
+		return false;
+	}
+	const S_NnHeader header = { NN_MAGIC, NN_VERSION, NN_INPUTS, NN_HIDDEN, NN_HIDDEN2, 0 };
+	fwrite(&header, sizeof(header), 1, file);
+	fwrite(network->inputWeights, sizeof(network->inputWeights), 1, file);
+	fwrite(network->inputBias, sizeof(network->inputBias), 1, file);
+	fwrite(network->hiddenWeights, sizeof(network->hiddenWeights), 1, file);
+	fwrite(network->hiddenBias, sizeof(network->hiddenBias), 1, file);
+	fwrite(network->outputWeights, sizeof(network->outputWeights), 1, file);
+	fwrite(network->outputBias, sizeof(network->outputBias), 1, file);
+	const bool written = !ferror(file);
+	fclose(file);
+	delete network;
+	return written;
+}
+
+/**
+ * Squared error of the win chance of an evaluation in the units of evaluateBoard.
+ */
+static float scoreLoss(int score, const S_Sample &sample) {
+	const float error = sigmoid(score / (float)SIGMOID_SCALE) - sigmoid(sample.score / (float)SIGMOID_SCALE);
+	return error * error;
+}
+
+int main(int argc, char **argv) {
+	const char *path = DEFAULT_FILE;
+	int positions = DEFAULT_POSITIONS, depth = DEFAULT_DEPTH, epochs = DEFAULT_EPOCHS;
+	int threads = (int)std::thread::hardware_concurrency();
+	bool valid = true;
+	for (int i = 1; i < argc; i++) {
+		const bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--positions") == 0 && hasValue)
+			positions = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--depth") == 0 && hasValue)
+			depth = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--epochs") == 0 && hasValue)
+			epochs = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+			threads = atoi(argv[++i]);
+		else if (argv[i][0] != '-')
+			path = argv[i];
+		else
+			valid = false;
+	}
+	if (!valid || positions < 100 || depth < 1 || epochs < 1) {
+		printf("usage: nntrain [file] [--positions N] [--depth N] [--epochs N] [--threads N]\n");
+		return 2;
+	}
+	if (threads < 1)
+		threads = 1; // hardware_concurrency is 0 when it can not tell
+
+	// Training data: the scores of depth searches of self-play positions
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<std::vector<S_Sample> > parts(threads);
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; t++)
+		workers.push_back(std::thread(collectSamples, 2018u + t, positions / threads + (t < positions % threads ? 1 : 0), depth, &parts[t]));
+	std::vector<S_Sample> samples;
+	for (int t = 0; t < threads; t++) {
+		workers[t].join();
+		samples.insert(samples.end(), parts[t].begin(), parts[t].end());
+	}
+	printf("%d positions searched to depth %d in %.1f s\n", (int)samples.size(),
+		depth, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+	std::mt19937 random(2018);
+	std::shuffle(samples.begin(), samples.end(), random);
+	const size_t validation = samples.size() * VALIDATION_PERCENT / 100;
+	const size_t training = samples.size() - validation;
+
+	S_Trainer trainer;
+	trainer.parameters.assign(P_COUNT, 0.0f);
+	trainer.gradients.assign(P_COUNT, 0.0f);
+	trainer.moment.assign(P_COUNT, 0.0f);
+	trainer.velocity.assign(P_COUNT, 0.0f);
+	trainer.steps = 0;
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	for (int k = P_INPUT_WEIGHTS; k < P_INPUT_BIAS; k++)
+		trainer.parameters[k] = 0.1f * uniform(random);
+	for (int k = P_INPUT_BIAS; k < P_HIDDEN_WEIGHTS; k++)
+		trainer.parameters[k] = 0.5f; // the middle of the clipped ReLU
+	for (int k = P_HIDDEN_WEIGHTS; k < P_HIDDEN_BIAS; k++)
+		trainer.parameters[k] = uniform(random) / sqrtf((float)NN_HIDDEN);
+	for (int k = P_HIDDEN_BIAS; k < P_OUTPUT_WEIGHTS; k++)
+		trainer.parameters[k] = 0.5f;
+	for (int k = P_OUTPUT_WEIGHTS; k < P_OUTPUT_BIAS; k++)
+		trainer.parameters[k] = uniform(random) / sqrtf((float)NN_HIDDEN2);
+
+	double classicLoss = 0;
+	for (size_t i = training; i < samples.size(); i++)
+		classicLoss += scoreLoss(samples[i].classic, samples[i]);
+	classicLoss /= validation ? validation : 1;
+
+	start = std::chrono::steady_clock::now();
+	for (int epoch = 1; epoch <= epochs; epoch++) {
+		std::shuffle(samples.begin(), samples.begin() + training, random);
+		double trainLoss = 0;
+		for (size_t begin = 0; begin < training; begin += BATCH_SIZE) {
+			const size_t end = std::min(training, begin + BATCH_SIZE);
+			for (size_t i = begin; i < end; i++)
+				trainLoss += trainSample(trainer.parameters, samples[i], trainer.gradients.data());
+			adamStep(trainer, (int)(end - begin));
+		}
+		double validationLoss = 0;
+		for (size_t i = training; i < samples.size(); i++)
+			validationLoss += trainSample(trainer.parameters, samples[i], NULL);
+		printf("epoch %2d: training loss %.5f | validation loss %.5f | %.1f s\n", epoch, trainLoss / training,
+			validationLoss / (validation ? validation : 1), std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	if (!writeNetwork(trainer.parameters, path)) {
+		printf("%s can not be written\n", path);
+		return 1;
+	}
+
+	// The written file, through the engine's own inference, against evaluateBoard
+	S_Network *network = new S_Network();
+	if (!nnLoad(*network, path)) {
+		printf("%s can not be read back\n", path);
+		delete network;
+		return 1;
+	}
+	double quantisedLoss = 0;
+	for (size_t i = training; i < samples.size(); i++) {
+		S_Accumulator accumulator;
+		memcpy(accumulator.values, network->inputBias, sizeof(accumulator.values));
+		for (int f = 0; f < samples[i].featureCount; f++)
+			for (int h = 0; h < NN_HIDDEN; h++)
+				accumulator.values[h] += network->inputWeights[samples[i].features[f]][h];
+		quantisedLoss += scoreLoss(nnEvaluate(*network, accumulator, samples[i].turn), samples[i]);
+	}
+	delete network;
+	printf("%s written | validation loss: quantised network %.5f, evaluateBoard %.5f\n", path,
+		quantisedLoss / (validation ? validation : 1), classicLoss);
+	return 0;
+}
@@ -0,0 +1,192 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   perft.cpp                                                                */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Console perft of the move generator: counts the positions reached        */
+/*   at every depth and checks them against known counts                      */
+/* ========================================================================== */
+
+#include "../engine/Position.h"
+#include <stdio.h>
+#include <stdlib.h> // for atoi
+#include <string.h>
+#include <chrono>
+
+#define MAX_KNOWN_DEPTH 10 /* depths with a known count for every test position */
+#define DEFAULT_DEPTH 8 /* depth of the check, the first argument overrides it */
+
+struct S_PerftPosition /* test position with the number of positions reached at every depth */
+{
+	const char *name;
+	const char *board; // side to move (w or b), ':', then square 0 to 31: b black man, B black king, w white man, W white king, . empty
+	unsigned long long known[MAX_KNOWN_DEPTH]; // counts of depth 1, 2, ...
+};
+
+/*
+ * The counts of the initial position are the published perft of English draughts.
+ * The counts of the other positions were recorded when the table generator and
+ * the row/col reference generator of movegen_bench agreed on them.
+ */
+static const S_PerftPosition perftPositions[] = {
+	{ "initial position", "w:bbbbbbbbbbbb........wwwwwwwwwwww",
+		{ 7, 49, 302, 1469, 7361, 36768, 179740, 845931, 3963680, 18391564 } },
+	{ "king capturing round back to its square", "w:..b...b..W..bb......bb.....ww...",
+		{ 2, 6, 34, 110, 668, 2112, 11954, 38980, 196208, 561790 } },
+	{ "man crowned by a jump ends the capture", "w:b....bb..w..........w.....Bw...w",
+		{ 1, 7, 18, 94, 485, 2327, 12511, 58697, 312658, 1416401 } },
+	{ "kings and men", "b:...W......b..B..B.....w..w..W...",
+		{ 6, 30, 183, 982, 5090, 26431, 144095, 782491, 4191025, 23012556 } },
+	{ "branching jump sequences", "b:b..b.b...ww......www.....ww.....",
+		{ 5, 42, 181, 1129, 5093, 29815, 130365, 729835, 3111958, 16694378 } },
+	{ "two captures with the same ends", "w:.........bbw.....bb..w..........",
+		{ 2, 8, 32, 112, 420, 1650, 5951, 21151, 98431, 381259 } },
+	{ "captures parting after a shared hop", "w:.........bb......bbb......bb..w.",
+		{ 3, 24, 48, 336, 672, 4640, 14108, 92478, 226956, 1425235 } },
+};
+
+/**
+ * Reads a test position.
+ * @param board - The position as described in S_PerftPosition.
+ * @param position - Receives the position, hash and score included.
+ * @return true when the text was a position.
+ */
+static bool parsePosition(const char *board, S_Position &position) {
+	if (strlen(board) != 2 + PLAYABLE_CELLS || (board[0] != 'w' && board[0] != 'b') || board[1] != ':')
+		return false;
+	position.white = 0;
+	position.black = 0;
+	position.kings = 0;
+	position.turn = board[0] == 'b' ? COMPUTER : PLAYER;
+	for (int square = 0; square < PLAYABLE_CELLS; square++) {
+		switch (board[2 + square]) {
+		case 'B': position.kings |= squareMask(square); // fall through
+		case 'b': position.black |= squareMask(square); break;
+		case 'W': position.kings |= squareMask(square); // fall through
+		case 'w': position.white |= squareMask(square); break;
+		case '.': break;
+		default: return false;
+		}
+	}
+	position.hash = hashPosition(position);
+	position.score = scorePosition(position);
+	return true;
+}
+
+/**
+ * Generates the legal moves of the side to move, only the captures when there is one.
+ * @param position - The current position.
+ * @param moves - Receives the moves.
+ */
+static void legalMoves(const S_Position &position, S_MoveList &moves) {
+	generateMoves(position, position.turn, moves);
+	if (isThereAttackMoves(moves))
+		filterAttackMoves(moves);
+}
+
+/**
+ * Counts the positions reached after depth moves.
+ * The last move is not applied, the positions it reaches are the number of moves.
+ * @param position - The current position, given back unchanged.
+ * @param depth - Remaining depth, at least 1.
+ * @return The number of positions at the given depth.
+ */
+static unsigned long long perft(S_Position &position, int depth) {
+	S_MoveList moves;
+	legalMoves(position, moves);
+	if (depth == 1)
+		return moves.count;
+	unsigned long long nodes = 0;
+	for (int i = 0; i < moves.count; i++) {
+		S_Undo undo;
+		applyMove(position, moves.moves[i], undo);
+		nodes += perft(position, depth - 1);
+		undoMove(position, undo);
+	}
+	return nodes;
+}
+
+/**
+ * Checks that every legal move reads back from its text as the same move. Captures with the same ends and
+ * different jumped stones are told apart by their landing squares only, the game's clicks pick them the same way.
+ * @param position - The position.
+ * @return The number of moves that did not read back.
+ */
+static int checkMoveTexts(const S_Position &position) {
+	S_MoveList moves;
+	legalMoves(position, moves);
+	int wrong = 0;
+	for (int i = 0; i < moves.count; i++) {
+		char text[MOVE_TEXT_SIZE];
+		moveToText(position, moves.moves[i], text);
+		S_Move move;
+		if (!moveFromText(position, text, move) || move.from != moves.moves[i].from || move.to != moves.moves[i].to || move.captured != moves.moves[i].captured) {
+			printf("  move %s does not read back\n", text);
+			wrong++;
+		}
+	}
+	return wrong;
+}
+
+/**
+ * Prints the count of every root move, to find the move a wrong count comes from.
+ * @param position - The position to split.
+ * @param depth - Depth of the counts, the root move included.
+ */
+static void divide(S_Position &position, int depth) {
+	S_MoveList moves;
+	legalMoves(position, moves);
+	for (int i = 0; i < moves.count; i++) {
+		const S_Move &move = moves.moves[i];
+		unsigned long long nodes = 1;
+		if (depth > 1) {
+			S_Undo undo;
+			applyMove(position, move, undo);
+			nodes = perft(position, depth - 1);
+			undoMove(position, undo);
+		}
+		printf("    (%d,%d) -> (%d,%d) jumps %d: %llu\n", squareRow(move.from), squareCol(move.from), squareRow(move.to), squareCol(move.to), move.attack, nodes);
+	}
+}
+
+int main(int argc, char **argv) {
+	const int depth = argc > 1 ? atoi(argv[1]) : DEFAULT_DEPTH;
+	const bool split = argc > 2 && strcmp(argv[2], "divide") == 0;
+	if (depth < 1) {
+		printf("usage: perft [depth] [divide]\n");
+		return 2;
+	}
+
+	int mismatches = 0;
+	unsigned long long totalNodes = 0;
+	double totalSeconds = 0;
+	for (size_t p = 0; p < sizeof(perftPositions) / sizeof(perftPositions[0]); p++) {
+		const S_PerftPosition &test = perftPositions[p];
+		S_Position position;
+		if (!parsePosition(test.board, position)) {
+			printf("%s: bad position %s\n", test.name, test.board);
+			return 2;
+		}
+		printf("%s (%s)\n", test.name, test.board);
+		mismatches += checkMoveTexts(position);
+		for (int d = 1; d <= depth; d++) {
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			const unsigned long long nodes = perft(position, d);
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			totalNodes += nodes;
+			totalSeconds += seconds;
+
+			const char *check = "";
+			if (d <= MAX_KNOWN_DEPTH) {
+				check = nodes == test.known[d - 1] ? "ok" : "WRONG";
+				if (nodes != test.known[d - 1])
+					mismatches++;
+			}
+			printf("  depth %2d | %12llu nodes | %8.3f s | %6.1f Mnodes/s | %s\n", d, nodes, seconds, seconds > 0 ? nodes / seconds / 1e6 : 0.0, check);
+		}
+		if (split)
+			divide(position, depth);
+	}
+	printf("%llu nodes in %.3f s, %.1f Mnodes/s, %d counts wrong\n", totalNodes, totalSeconds, totalSeconds > 0 ? totalNodes / totalSeconds / 1e6 : 0.0, mismatches);
+	return mismatches ? 1 : 0;
+}
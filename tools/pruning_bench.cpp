@@ -0,0 +1,157 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   pruning_bench.cpp                                                        */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Console benchmark of the pruning techniques of the search                */
+/*   node reduction and strength of each one separately                       */
+/* ========================================================================== */
+
+#include "../engine/Search.h"
+#include <stdio.h>
+#include <stdlib.h> // for srand, rand and atoi
+#include <vector>
+
+#define BENCH_POSITIONS 40 /* positions searched for every configuration */
+#define RANDOM_PLIES 10 /* random moves played from the start to reach each position */
+#define OPENING_PLIES 6 /* random moves at the start of every match game */
+#define MAX_GAME_PLIES 200 /* match games longer than that are draws */
+#define BENCH_TABLE_MB 16 /* transposition table of every search */
+
+struct S_Config /* one combination of the pruning techniques */
+{
+	const char *name;
+	S_SearchOptions options;
+};
+
+static S_Config makeConfig(const char *name, bool lateMoveReductions, bool nullMove, bool probCut) {
+	S_Config config;
+	config.name = name;
+	config.options.lateMoveReductions = lateMoveReductions;
+	config.options.nullMove = nullMove;
+	config.options.probCut = probCut;
+	return config;
+}
+
+/**
+ * Generates the legal moves of the side to move, captures only when there is one.
+ */
+static void legalMoves(const S_Position &position, S_MoveList &moves) {
+	generateMoves(position, position.turn, moves);
+	if (isThereAttackMoves(moves))
+		filterAttackMoves(moves);
+}
+
+/**
+ * Plays random moves from the start and collects the positions reached, skipping the ones with a single legal move.
+ * @param positions - Receives the positions.
+ */
+static void buildPositions(std::vector<S_Position> &positions) {
+	srand(2018);
+	while ((int)positions.size() < BENCH_POSITIONS) {
+		S_Position position = initialPosition();
+		S_MoveList moves;
+		for (int ply = 0; ply < RANDOM_PLIES; ply++) {
+			legalMoves(position, moves);
+			if (moves.count == 0)
+				break;
+			S_Undo undo;
+			applyMove(position, moves.moves[rand() % moves.count], undo);
+		}
+		legalMoves(position, moves);
+		if (moves.count > 1)
+			positions.push_back(position);
+	}
+}
+
+/**
+ * Plays one game between two configurations, each move searched for the same time.
+ * @param first - Configuration of the side to move first (PLAYER).
+ * @param second - Configuration of the other side.
+ * @param seed - Seed of the random opening, both games of a pair use the same one.
+ * @return 1 if first won, -1 if second won, 0 for a draw (too long).
+ */
+static int playGame(const S_Config &first, const S_Config &second, int milliseconds, unsigned seed, S_TransTable &table) {
+	srand(seed);
+	S_Position position = initialPosition();
+	ttClear(table);
+	for (int ply = 0; ply < MAX_GAME_PLIES; ply++) {
+		S_MoveList moves;
+		legalMoves(position, moves);
+		if (moves.count == 0)
+			return position.turn == PLAYER ? -1 : 1;
+		S_Move move;
+		if (ply < OPENING_PLIES) {
+			move = moves.moves[rand() % moves.count];
+		} else {
+			S_SearchLimits limits;
+			limits.milliseconds = milliseconds;
+			limits.options = position.turn == PLAYER ? first.options : second.options;
+			move = iterativeDeepening(position, limits, &table).move;
+		}
+		S_Undo undo;
+		applyMove(position, move, undo);
+	}
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	const int depth = argc > 1 ? atoi(argv[1]) : 12;
+	const int games = argc > 2 ? atoi(argv[2]) : 40;
+	const int milliseconds = argc > 3 ? atoi(argv[3]) : 20;
+
+	const S_Config configs[] = {
+		makeConfig("none", false, false, false),
+		makeConfig("lmr", true, false, false),
+		makeConfig("null move", false, true, false),
+		makeConfig("probcut", false, false, true),
+		makeConfig("default", S_SearchOptions().lateMoveReductions, S_SearchOptions().nullMove, S_SearchOptions().probCut),
+		makeConfig("all", true, true, true),
+	};
+	const int configCount = sizeof(configs) / sizeof(configs[0]);
+
+	std::vector<S_Position> positions;
+	buildPositions(positions);
+	S_TransTable table;
+	ttResize(table, BENCH_TABLE_MB);
+
+	// Node reduction: every configuration searches the same positions to the same depth
+	printf("%d positions to depth %d\n", (int)positions.size(), depth);
+	printf("%-10s | %11s | %6s | %8s | %8s | %8s | %8s\n", "config", "nodes", "of none", "reduced", "research", "null cut", "probcut");
+	unsigned long long noneNodes = 0;
+	for (int c = 0; c < configCount; c++) {
+		S_SearchStats total;
+		for (size_t i = 0; i < positions.size(); i++) {
+			ttClear(table);
+			const S_SearchResult result = searchRoot(positions[i], depth, &table, configs[c].options);
+			total.nodes += result.stats.nodes;
+			total.lmrReductions += result.stats.lmrReductions;
+			total.lmrResearches += result.stats.lmrResearches;
+			total.nullCutoffs += result.stats.nullCutoffs;
+			total.probCuts += result.stats.probCuts;
+		}
+		if (c == 0)
+			noneNodes = total.nodes;
+		printf("%-10s | %11llu | %6.1f%% | %8llu | %8llu | %8llu | %8llu\n", configs[c].name, total.nodes, 100.0 * total.nodes / noneNodes,
+			total.lmrReductions, total.lmrResearches, total.nullCutoffs, total.probCuts);
+	}
+
+	// Strength: every configuration plays the one without pruning, the same time per move
+	printf("\n%d games against \"none\", %d ms per move\n", games, milliseconds);
+	for (int c = 1; c < configCount; c++) {
+		int wins = 0, losses = 0, draws = 0;
+		for (int game = 0; game < games; game++) {
+			const bool first = game % 2 == 0; // colors alternate, each opening is played from both sides
+			const int result = first ? playGame(configs[c], configs[0], milliseconds, game / 2 + 1, table)
+				: -playGame(configs[0], configs[c], milliseconds, game / 2 + 1, table);
+			if (result > 0)
+				wins++;
+			else if (result < 0)
+				losses++;
+			else
+				draws++;
+		}
+		printf("%-10s | +%d -%d =%d | score %.1f%%\n", configs[c].name, wins, losses, draws, games ? 100.0 * (wins + 0.5 * draws) / games : 0.0);
+	}
+	return 0;
+}
@@ -0,0 +1,92 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   search_bench.cpp                                                         */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Console benchmark of the alpha-beta search                               */
+/*   with transposition tables of different sizes                             */
+/*   and of the move ordering (first move cutoffs)                            */
+/* ========================================================================== */
+
+#include "../engine/Search.h"
+#include <stdio.h>
+#include <stdlib.h> // for srand, rand and atoi
+#include <vector>
+#include <chrono>
+
+#define CORPUS_GAMES 10 /* games played to collect the corpus */
+#define RANDOM_OPENING_PLIES 6 /* random moves at the start of every game so the games differ */
+#define MAX_GAME_PLIES 120 /* games longer than that are stopped */
+#define DEFAULT_DEPTH 8 /* depth of the timed searches, the first argument overrides it */
+
+/**
+ * Plays random games and collects every position reached, the way the game would meet them one after another.
+ * Checks on the way that the hash and the score applyMove keeps up to date are the ones computed from scratch.
+ * @param corpus - Receives the positions.
+ * @return The number of positions whose incremental hash or score was wrong.
+ */
+static int buildCorpus(std::vector<S_Position> &corpus) {
+	int wrongPositions = 0;
+	srand(2018);
+	for (int game = 0; game < CORPUS_GAMES; game++) {
+		S_Position position = initialPosition();
+		for (int ply = 0; ply < MAX_GAME_PLIES; ply++) {
+			if (position.hash != hashPosition(position) || position.score != scorePosition(position))
+				wrongPositions++;
+			corpus.push_back(position);
+			S_MoveList moves;
+			generateMoves(position, position.turn, moves);
+			if (isThereAttackMoves(moves))
+				filterAttackMoves(moves);
+			if (moves.count == 0)
+				break; // game over
+			S_Move move;
+			if (ply < RANDOM_OPENING_PLIES)
+				move = moves.moves[rand() % moves.count];
+			else
+				move = searchRoot(position, 4).move;
+			S_Undo undo;
+			applyMove(position, move, undo);
+		}
+	}
+	return wrongPositions;
+}
+
+/**
+ * Searches every position of the corpus in order, keeping the table between searches like the game does.
+ * @param megabytes - Size of the table, 0 to search without one.
+ */
+static void runSearches(const std::vector<S_Position> &corpus, int depth, size_t megabytes) {
+	S_TransTable table;
+	if (megabytes)
+		ttResize(table, megabytes);
+	S_SearchStats total;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < corpus.size(); i++) {
+		const S_SearchResult result = searchRoot(corpus[i], depth, megabytes ? &table : NULL);
+		total.nodes += result.stats.nodes;
+		total.ttProbes += result.stats.ttProbes;
+		total.ttHits += result.stats.ttHits;
+		total.ttCutoffs += result.stats.ttCutoffs;
+		total.betaCutoffs += result.stats.betaCutoffs;
+		total.firstMoveCutoffs += result.stats.firstMoveCutoffs;
+		total.qNodes += result.stats.qNodes;
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("%4d MB | %12llu nodes | %7.2f s | hits %5.1f%% | cutoffs %5.1f%% of probes | first move cutoffs %5.1f%% | quiescence %4.1f%% of nodes\n", (int)megabytes, total.nodes, seconds,
+		total.ttProbes ? 100.0 * total.ttHits / total.ttProbes : 0.0, total.ttProbes ? 100.0 * total.ttCutoffs / total.ttProbes : 0.0,
+		total.betaCutoffs ? 100.0 * total.firstMoveCutoffs / total.betaCutoffs : 0.0, total.nodes ? 100.0 * total.qNodes / total.nodes : 0.0);
+}
+
+int main(int argc, char **argv) {
+	const int depth = argc > 1 ? atoi(argv[1]) : DEFAULT_DEPTH;
+	std::vector<S_Position> corpus;
+	const int wrongPositions = buildCorpus(corpus);
+	printf("corpus: %d positions from %d games, %d incremental hashes or scores wrong\n", (int)corpus.size(), CORPUS_GAMES, wrongPositions);
+	printf("depth %d\n", depth);
+
+	static const size_t sizes[] = { 0, 1, 4, 16, 64, 256 };
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		runSearches(corpus, depth, sizes[i]);
+	return wrongPositions ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   smp_bench.cpp                                                            */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Console benchmark of the lazy SMP search                                 */
+/*   nodes per second and time to depth for 1 to 16 threads                   */
+/* ========================================================================== */
+
+#include "../engine/Search.h"
+#include <stdio.h>
+#include <stdlib.h> // for srand, rand and atoi
+#include <vector>
+#include <thread>
+
+#define BENCH_POSITIONS 24 /* positions searched for every thread count */
+#define RANDOM_PLIES 10 /* random moves played from the start to reach each position */
+#define DEFAULT_DEPTH 14 /* depth every search goes to, the first argument overrides it */
+#define BENCH_TABLE_MB 64 /* transposition table shared by the threads */
+
+/**
+ * Plays random moves from the start and collects the positions reached, skipping the ones with a single legal move.
+ * @param positions - Receives the positions.
+ */
+static void buildPositions(std::vector<S_Position> &positions) {
+	srand(2018);
+	while ((int)positions.size() < BENCH_POSITIONS) {
+		S_Position position = initialPosition();
+		for (int ply = 0; ply < RANDOM_PLIES; ply++) {
+			S_MoveList moves;
+			generateMoves(position, position.turn, moves);
+			if (isThereAttackMoves(moves))
+				filterAttackMoves(moves);
+			if (moves.count == 0)
+				break;
+			S_Undo undo;
+			applyMove(position, moves.moves[rand() % moves.count], undo);
+		}
+		S_MoveList moves;
+		generateMoves(position, position.turn, moves);
+		if (isThereAttackMoves(moves))
+			filterAttackMoves(moves);
+		if (moves.count > 1)
+			positions.push_back(position);
+	}
+}
+
+int main(int argc, char **argv) {
+	const int depth = argc > 1 ? atoi(argv[1]) : DEFAULT_DEPTH;
+	std::vector<S_Position> positions;
+	buildPositions(positions);
+	printf("%d positions, depth %d, %d MB table, %u cores\n", (int)positions.size(), depth, BENCH_TABLE_MB, std::thread::hardware_concurrency());
+	printf("threads |      nodes |  seconds |    knodes/s | time to depth speedup\n");
+
+	static const int threadCounts[] = { 1, 2, 4, 8, 16 };
+	double oneThreadSeconds = 0;
+	S_TransTable table;
+	ttResize(table, BENCH_TABLE_MB);
+	for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++) {
+		S_SearchLimits limits;
+		limits.depth = depth;
+		limits.threads = threadCounts[t];
+		unsigned long long nodes = 0;
+		double seconds = 0;
+		for (size_t i = 0; i < positions.size(); i++) {
+			ttClear(table); // every search starts from the same empty table
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			const S_SearchResult result = iterativeDeepening(positions[i], limits, &table);
+			seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			nodes += result.stats.nodes;
+		}
+		if (t == 0)
+			oneThreadSeconds = seconds;
+		printf("%7d | %10llu | %8.2f | %11.0f | %.2fx\n", threadCounts[t], nodes, seconds, nodes / seconds / 1000, oneThreadSeconds / seconds);
+	}
+	return 0;
+}
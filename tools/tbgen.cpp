@@ -0,0 +1,485 @@
+/* ========================================================================== */
+/*                                                                            */
+/*   tbgen.cpp                                                                */
+/*   (c) 2018 Student authors & co-author                                  */
+/*                                                                            */
+/*   Console generator of the endgame tablebase: retrograde analysis          */
+/*   of every position with few stones, written compressed for tbProbe        */
+/* ========================================================================== */
+
+#include "../engine/Tablebase.h"
+#include <stdio.h>
+#include <stdlib.h> // for atoi
+#include <limits.h> // for UINT_MAX
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <algorithm> // for std::sort and std::max
+#include <chrono>
+
+#define DEFAULT_PIECES 4 /* stones of the biggest slices, the first argument overrides it */
+#define DEFAULT_FILE "checkers.tb"
+#define MAX_DISTANCE 252 /* longest distance a value can hold */
+#define UNRESOLVED 0 /* value of a position not solved yet, the ones left at the end are draws */
+
+struct S_Slice /* values of every index of one material, see Tablebase.h */
+{
+	S_TbMaterial material;
+	unsigned long long entries;
+	std::vector<unsigned char> values;
+};
+
+struct S_Generator
+{
+	int maxPieces;
+	int threads;
+	std::vector<S_Slice> slices;
+	std::vector<int> sliceOfKey; // tbSliceKey to index of slices, -1 for a material without a slice
+};
+
+struct S_Update /* a position solved by a pass, applied once every thread is done */
+{
+	int slice;
+	unsigned int index;
+	unsigned char value;
+};
+
+struct S_Successor /* position a move leads to, in a slice of the group being solved */
+{
+	unsigned int index;
+	int slot; // which slice of the group
+};
+
+struct S_Pending /* position not solved yet, with what its moves lead to */
+{
+	unsigned int index; // in its slice
+	int slot; // which slice of the group
+	int shortestWin; // through a move to a lost position of a slice solved before, MAX_DISTANCE + 1 for none
+	int longestLoss; // over the moves to won positions of slices solved before
+	bool allLose; // every move to a slice solved before leads to a won position
+	unsigned int firstSuccessor, successorCount; // the moves that stay in the group, in S_Work::successors
+};
+
+struct S_Work /* a thread's share of the positions of a group */
+{
+	std::vector<S_Pending> pending;
+	std::vector<S_Successor> successors;
+	std::vector<S_Update> updates; // solved by the last pass
+	int waiting; // deepest level a pending position waits for
+};
+
+/**
+ * Adds the value of a successor to what the moves of a position lead to.
+ * @param value - Value of the successor, from the side to move there.
+ */
+static void addSuccessor(unsigned char value, int &shortestWin, int &longestLoss, bool &allLose) {
+	if (value == UNRESOLVED) {
+		allLose = false;
+		return;
+	}
+	int distance;
+	if (tbDecodeValue(value, distance) == TB_LOSS)
+		shortestWin = std::min(shortestWin, distance + 1);
+	else
+		longestLoss = std::max(longestLoss, distance + 1);
+}
+
+/**
+ * Reads the thread's share of the positions of a group and sorts their moves: the values of the slices solved
+ * before are final, so they are read once here, the moves staying in the group are kept to be read at every pass.
+ * @param generator - The slices, the ones of the group get TB_NOT_A_POSITION where stones overlap.
+ * @param group - Slices solved together.
+ * @param thread - Number of the thread, selects its share of every slice.
+ * @param work - Receives the pending positions.
+ */
+static void prepareShare(S_Generator *generator, const std::vector<int> *group, int thread, S_Work *work) {
+	for (size_t slot = 0; slot < group->size(); slot++) {
+		S_Slice &slice = generator->slices[(*group)[slot]];
+		const unsigned long long begin = slice.entries * thread / generator->threads, end = slice.entries * (thread + 1) / generator->threads;
+		for (unsigned long long index = begin; index < end; index++) {
+			S_Position position;
+			if (!tbDecode(slice.material, index, position)) {
+				slice.values[index] = TB_NOT_A_POSITION;
+				continue;
+			}
+			S_Pending pending = { (unsigned int)index, (int)slot, MAX_DISTANCE + 1, 0, true, (unsigned int)work->successors.size(), 0 };
+			S_MoveList moves;
+			generateMoves(position, PLAYER, moves);
+			if (isThereAttackMoves(moves))
+				filterAttackMoves(moves);
+			for (int i = 0; i < moves.count; i++) {
+				S_Position next = position;
+				S_Undo undo;
+				applyMove(next, moves.moves[i], undo);
+				if (!next.black) {
+					pending.shortestWin = 1; // the last stone was taken
+					continue;
+				}
+				const S_Position normalized = tbNormalize(next);
+				const int sliceIndex = generator->sliceOfKey[tbSliceKey(tbMaterial(normalized), generator->maxPieces)];
+				const unsigned int nextIndex = (unsigned int)tbIndex(normalized);
+				const std::vector<int>::const_iterator inGroup = std::find(group->begin(), group->end(), sliceIndex);
+				if (inGroup != group->end()) {
+					S_Successor successor = { nextIndex, (int)(inGroup - group->begin()) };
+					work->successors.push_back(successor);
+					pending.successorCount++;
+				} else {
+					addSuccessor(generator->slices[sliceIndex].values[nextIndex], pending.shortestWin, pending.longestLoss, pending.allLose);
+				}
+			}
+			work->pending.push_back(pending);
+		}
+	}
+}
+
+/**
+ * Runs one pass over the thread's pending positions: solves the ones that win or lose in level plies.
+ * A win is the shortest win a move leads to, a loss the longest, so every value it reads must be of a lower level:
+ * the values solved by the pass are only written once every thread is done.
+ * @param generator - The slices, only read.
+ * @param group - Slices solved together.
+ * @param level - Distance solved by this pass.
+ * @param work - The thread's share, the positions solved by the last pass are dropped, the new ones are its updates.
+ */
+static void solveShare(const S_Generator *generator, const std::vector<int> *group, int level, S_Work *work) {
+	size_t kept = 0;
+	for (size_t i = 0; i < work->pending.size(); i++)
+		if (generator->slices[(*group)[work->pending[i].slot]].values[work->pending[i].index] == UNRESOLVED)
+			work->pending[kept++] = work->pending[i];
+	work->pending.resize(kept);
+	work->updates.clear();
+	work->waiting = 0;
+
+	for (size_t i = 0; i < work->pending.size(); i++) {
+		const S_Pending &pending = work->pending[i];
+		int shortestWin = pending.shortestWin, longestLoss = pending.longestLoss;
+		bool allLose = pending.allLose;
+		for (unsigned int s = pending.firstSuccessor; s < pending.firstSuccessor + pending.successorCount; s++) {
+			const S_Successor &successor = work->successors[s];
+			addSuccessor(generator->slices[(*group)[successor.slot]].values[successor.index], shortestWin, longestLoss, allLose);
+		}
+		unsigned char value = UNRESOLVED;
+		if (shortestWin <= MAX_DISTANCE) {
+			if (shortestWin <= level)
+				value = tbEncodeValue(TB_WIN, shortestWin);
+			else
+				work->waiting = std::max(work->waiting, shortestWin);
+		} else if (allLose) { // no move at all is a loss in 0 plies
+			if (longestLoss <= level)
+				value = tbEncodeValue(TB_LOSS, longestLoss);
+			else
+				work->waiting = std::max(work->waiting, longestLoss);
+		}
+		if (value != UNRESOLVED) {
+			S_Update update = { (*group)[pending.slot], pending.index, value };
+			work->updates.push_back(update);
+		}
+	}
+}
+
+/**
+ * Solves a slice and its mirror, the slice with the stones of the two sides swapped.
+ * The moves that neither capture nor crown lead from one to the other, every other move to a slice solved before.
+ * Level by level: a pass solves the positions that win or lose in that many plies, until no position
+ * is solved anymore nor waits for a deeper level. The positions left are draws.
+ * @param generator - The slices, the ones of the group are filled in.
+ * @param group - The slice and its mirror, or only the slice when it is its own mirror.
+ * @return The longest distance of the group.
+ */
+static int solveGroup(S_Generator &generator, const std::vector<int> &group) {
+	for (size_t slot = 0; slot < group.size(); slot++) {
+		S_Slice &slice = generator.slices[group[slot]];
+		slice.values.assign(slice.entries, UNRESOLVED);
+	}
+	std::vector<S_Work> work(generator.threads);
+	std::vector<std::thread> threads;
+	for (int t = 1; t < generator.threads; t++)
+		threads.push_back(std::thread(prepareShare, &generator, &group, t, &work[t]));
+	prepareShare(&generator, &group, 0, &work[0]);
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+
+	int longest = 0;
+	for (int level = 0; ; level++) {
+		if (level > MAX_DISTANCE) {
+			printf("a distance is longer than %d plies, it does not fit in a value\n", MAX_DISTANCE);
+			exit(1);
+		}
+		threads.clear();
+		for (int t = 1; t < generator.threads; t++)
+			threads.push_back(std::thread(solveShare, &generator, &group, level, &work[t]));
+		solveShare(&generator, &group, level, &work[0]);
+		for (size_t t = 0; t < threads.size(); t++)
+			threads[t].join();
+
+		size_t solved = 0;
+		int deepest = 0;
+		for (int t = 0; t < generator.threads; t++) {
+			for (size_t i = 0; i < work[t].updates.size(); i++)
+				generator.slices[work[t].updates[i].slice].values[work[t].updates[i].index] = work[t].updates[i].value;
+			solved += work[t].updates.size();
+			deepest = std::max(deepest, work[t].waiting);
+		}
+		if (solved)
+			longest = level;
+		if (!solved && deepest <= level)
+			break;
+	}
+	return longest;
+}
+
+/**
+ * Compresses a slice into blocks of TB_BLOCK_ENTRIES values, each run length coded or packed on a palette,
+ * whichever is shorter, or raw when neither is shorter.
+ * The values where stones overlap, and the ones of the positions with a capture to play, which tbProbe
+ * finds through the captures, are never read: they repeat the value before them so the runs are longer.
+ * @param slice - A solved slice.
+ * @param offsets - Receives blockCount + 1 block offsets.
+ * @param blocks - Receives the blocks.
+ * @return false when the blocks are too long for a block offset, the kind takes its high bits.
+ */
+static bool compressSlice(const S_Slice &slice, std::vector<unsigned int> &offsets, std::vector<unsigned char> &blocks) {
+	std::vector<unsigned char> values = slice.values;
+	unsigned char previous = 0;
+	for (size_t i = 0; i < values.size(); i++) {
+		bool unread = values[i] == TB_NOT_A_POSITION;
+		if (!unread) {
+			S_Position position;
+			tbDecode(slice.material, i, position);
+			S_MoveList moves;
+			generateMoves(position, PLAYER, moves);
+			unread = isThereAttackMoves(moves) != 0;
+		}
+		if (unread)
+			values[i] = previous;
+		previous = values[i];
+	}
+
+	std::vector<unsigned char> coded;
+	for (size_t begin = 0; begin < values.size(); begin += TB_BLOCK_ENTRIES) {
+		const size_t end = std::min(values.size(), begin + TB_BLOCK_ENTRIES);
+		coded.clear();
+		for (size_t i = begin; i < end; ) {
+			size_t run = 1;
+			while (i + run < end && values[i + run] == values[i])
+				run++;
+			coded.push_back((unsigned char)(run - 1));
+			coded.push_back(values[i]);
+			i += run;
+		}
+		// The same values on the fewest bits
+		std::vector<unsigned char> palette;
+		for (size_t i = begin; i < end; i++)
+			if (std::find(palette.begin(), palette.end(), values[i]) == palette.end())
+				palette.push_back(values[i]);
+		int bits = 0;
+		while ((1u << bits) < palette.size())
+			bits++;
+		std::vector<unsigned char> packed(((end - begin) * bits + 7) / 8 + 1, 0); // one padding byte, the probe reads two
+		for (size_t i = begin; i < end; i++) {
+			const size_t bit = (i - begin) * bits;
+			const unsigned int colour = (unsigned int)(std::find(palette.begin(), palette.end(), values[i]) - palette.begin());
+			packed[bit / 8] |= (unsigned char)(colour << (bit % 8));
+			packed[bit / 8 + 1] |= (unsigned char)((colour << (bit % 8)) >> 8);
+		}
+		const size_t paletteSize = 1 + palette.size() + packed.size();
+
+		if (coded.size() <= paletteSize && coded.size() < end - begin) {
+			offsets.push_back((unsigned int)blocks.size() | TB_RUN_BLOCK);
+			blocks.insert(blocks.end(), coded.begin(), coded.end());
+		} else if (paletteSize < end - begin) {
+			offsets.push_back((unsigned int)blocks.size() | TB_PALETTE_BLOCK);
+			blocks.push_back((unsigned char)(palette.size() - 1));
+			blocks.insert(blocks.end(), palette.begin(), palette.end());
+			blocks.insert(blocks.end(), packed.begin(), packed.end());
+		} else {
+			offsets.push_back((unsigned int)blocks.size() | TB_RAW_BLOCK);
+			blocks.insert(blocks.end(), values.begin() + begin, values.begin() + end);
+		}
+	}
+	offsets.push_back((unsigned int)blocks.size());
+	return blocks.size() <= (size_t)~TB_BLOCK_KIND;
+}
+
+/**
+ * Writes the tablebase file, see the layout in Tablebase.h.
+ * @return The size of the file, 0 when it could not be written.
+ */
+static unsigned long long writeTablebase(const S_Generator &generator, const char *path) {
+	FILE *file = fopen(path, "wb");
+	if (!file)
+		return 0;
+	S_TbHeader header = { TB_MAGIC, TB_VERSION, (unsigned int)generator.maxPieces, 0 };
+	std::vector<unsigned long long> sliceOffsets(generator.sliceOfKey.size(), 0);
+	fwrite(&header, sizeof(header), 1, file);
+	fwrite(sliceOffsets.data(), sizeof(unsigned long long), sliceOffsets.size(), file);
+	unsigned long long position = sizeof(header) + sliceOffsets.size() * sizeof(unsigned long long);
+
+	for (size_t s = 0; s < generator.slices.size(); s++) {
+		const S_Slice &slice = generator.slices[s];
+		std::vector<unsigned int> offsets;
+		std::vector<unsigned char> blocks;
+		if (!compressSlice(slice, offsets, blocks)) {
+			printf("%d men %d kings vs %d men %d kings: %llu bytes of blocks, more than a block offset holds\n", slice.material.men,
+				slice.material.kings, slice.material.otherMen, slice.material.otherKings, (unsigned long long)blocks.size());
+			fclose(file);
+			return 0;
+		}
+		static const unsigned char padding[8] = {};
+		const unsigned long long pad = (8 - position % 8) % 8; // slice headers are 8 byte aligned
+		fwrite(padding, 1, (size_t)pad, file);
+		position += pad;
+		sliceOffsets[tbSliceKey(slice.material, generator.maxPieces)] = position;
+		S_TbSliceHeader sliceHeader = { slice.entries, offsets.size() - 1 };
+		fwrite(&sliceHeader, sizeof(sliceHeader), 1, file);
+		fwrite(offsets.data(), sizeof(unsigned int), offsets.size(), file);
+		fwrite(blocks.data(), 1, blocks.size(), file);
+		position += sizeof(sliceHeader) + offsets.size() * sizeof(unsigned int) + blocks.size();
+	}
+
+	fseek(file, sizeof(header), SEEK_SET);
+	fwrite(sliceOffsets.data(), sizeof(unsigned long long), sliceOffsets.size(), file);
+	const bool written = !ferror(file);
+	fclose(file);
+	return written ? position : 0;
+}
+
+/**
+ * Probes every position of the written file and compares it with the generated value.
+ * @return The number of positions that differ.
+ */
+static unsigned long long verifyTablebase(const S_Generator &generator, const char *path) {
+	S_Tablebase tablebase;
+	if (!tbOpen(tablebase, path)) {
+		printf("%s can not be opened as a tablebase\n", path);
+		return 1;
+	}
+	unsigned long long wrong = 0;
+	for (size_t s = 0; s < generator.slices.size(); s++) {
+		const S_Slice &slice = generator.slices[s];
+		for (unsigned long long index = 0; index < slice.entries; index++) {
+			S_Position position;
+			if (!tbDecode(slice.material, index, position))
+				continue;
+			int distance, expected;
+			const E_TbResult result = tbProbe(tablebase, position, distance);
+			if (result != tbDecodeValue(slice.values[index], expected) || distance != expected)
+				wrong++;
+		}
+	}
+	return wrong;
+}
+
+int main(int argc, char **argv) {
+	S_Generator generator;
+	generator.maxPieces = DEFAULT_PIECES;
+	generator.threads = (int)std::thread::hardware_concurrency();
+	const char *path = DEFAULT_FILE;
+	int positional = 0;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			generator.threads = atoi(argv[++i]);
+		else if (positional == 0 && argv[i][0] != '-')
+			generator.maxPieces = atoi(argv[i]), positional++;
+		else if (positional == 1 && argv[i][0] != '-')
+			path = argv[i], positional++;
+		else
+			generator.maxPieces = 0;
+	}
+	if (generator.maxPieces < 2 || generator.maxPieces > TB_MAX_PIECES) {
+		printf("usage: tbgen [pieces, 2 to %d] [file] [--threads N]\n", TB_MAX_PIECES);
+		return 2;
+	}
+	if (generator.threads < 1)
+		generator.threads = 1; // hardware_concurrency is 0 when it can not tell
+
+	// Every material with stones on both sides, fewer stones first, then fewer men: captures and crowning lead there
+	const int n = generator.maxPieces + 1;
+	generator.sliceOfKey.assign((size_t)n * n * n * n, -1);
+	for (int men = 0; men < n; men++)
+		for (int kings = 0; men + kings < n; kings++)
+			for (int otherMen = 0; men + kings + otherMen < n; otherMen++)
+				for (int otherKings = 0; men + kings + otherMen + otherKings < n; otherKings++) {
+					if (men + kings == 0 || otherMen + otherKings == 0)
+						continue;
+					S_Slice slice;
+					slice.material.men = men;
+					slice.material.kings = kings;
+					slice.material.otherMen = otherMen;
+					slice.material.otherKings = otherKings;
+					slice.entries = tbSliceEntries(slice.material);
+					if (slice.entries > UINT_MAX) { // the indexes of S_Pending, S_Successor and S_Update
+						printf("%d men %d kings vs %d men %d kings: %llu positions, more than an index holds\n", men, kings, otherMen, otherKings, slice.entries);
+						return 1;
+					}
+					generator.slices.push_back(slice);
+				}
+	std::sort(generator.slices.begin(), generator.slices.end(), [](const S_Slice &a, const S_Slice &b) {
+		const int stonesA = a.material.men + a.material.kings + a.material.otherMen + a.material.otherKings;
+		const int stonesB = b.material.men + b.material.kings + b.material.otherMen + b.material.otherKings;
+		if (stonesA != stonesB)
+			return stonesA < stonesB;
+		return a.material.men + a.material.otherMen < b.material.men + b.material.otherMen;
+	});
+	for (size_t s = 0; s < generator.slices.size(); s++)
+		generator.sliceOfKey[tbSliceKey(generator.slices[s].material, generator.maxPieces)] = (int)s;
+
+	printf("tablebase of up to %d stones on %d threads\n", generator.maxPieces, generator.threads);
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<bool> solved(generator.slices.size(), false);
+	for (size_t s = 0; s < generator.slices.size(); s++) {
+		if (solved[s])
+			continue;
+		const S_TbMaterial &material = generator.slices[s].material;
+		S_TbMaterial mirror = { material.otherMen, material.otherKings, material.men, material.kings };
+		std::vector<int> group(1, (int)s);
+		const int mirrorSlice = generator.sliceOfKey[tbSliceKey(mirror, generator.maxPieces)];
+		if (mirrorSlice != (int)s)
+			group.push_back(mirrorSlice);
+
+		const std::chrono::steady_clock::time_point groupStart = std::chrono::steady_clock::now();
+		const int longest = solveGroup(generator, group);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - groupStart).count();
+		for (size_t g = 0; g < group.size(); g++) {
+			const S_Slice &slice = generator.slices[group[g]];
+			unsigned long long wins = 0, losses = 0, draws = 0;
+			for (unsigned long long index = 0; index < slice.entries; index++) {
+				const unsigned char value = slice.values[index];
+				if (value == TB_NOT_A_POSITION)
+					continue;
+				int distance;
+				const E_TbResult result = tbDecodeValue(value, distance);
+				if (result == TB_WIN)
+					wins++;
+				else if (result == TB_LOSS)
+					losses++;
+				else
+					draws++;
+			}
+			printf("  %d men %d kings vs %d men %d kings | %10llu positions | win %5.1f%% loss %5.1f%% draw %5.1f%%",
+				slice.material.men, slice.material.kings, slice.material.otherMen, slice.material.otherKings, wins + losses + draws,
+				100.0 * wins / (wins + losses + draws), 100.0 * losses / (wins + losses + draws), 100.0 * draws / (wins + losses + draws));
+			if (g == 0)
+				printf(" | longest %3d plies | %.2f s\n", longest, seconds);
+			else
+				printf(" | (mirror)\n");
+			solved[group[g]] = true;
+		}
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	unsigned long long raw = 0;
+	for (size_t s = 0; s < generator.slices.size(); s++)
+		raw += generator.slices[s].entries;
+	const unsigned long long size = writeTablebase(generator, path);
+	if (!size) {
+		printf("%s can not be written\n", path);
+		return 1;
+	}
+	printf("%d slices solved in %.1f s, %s written: %llu bytes for %llu values (%.1f%%)\n", (int)generator.slices.size(), seconds,
+		path, size, raw, 100.0 * size / raw);
+
+	const unsigned long long wrong = verifyTablebase(generator, path);
+	printf("probe check: %llu positions read back wrong\n", wrong);
+	return wrong ? 1 : 0;
+}